@@ -0,0 +1,269 @@
+#include "BenchmarkApp.hpp"
+
+#include <cmath>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <opencv2/highgui/highgui.hpp>
+
+#include "../src/utils/json/json.hpp"
+#include "../src/utils/logger/Logger.hpp"
+#include "../src/utils/cmd-parser/CmdParser.hpp"
+#include "../src/utils/performance-timer/PerformanceTimer.hpp"
+
+namespace json = pobr::utils::json;
+
+using Logger = pobr::utils::Logger;
+using CmdParser = pobr::utils::CmdParser;
+using PerformanceTimer = pobr::utils::PerformanceTimer;
+using ImgProcessor = pobr::imgProcessing::ImgProcessor;
+using Classifier = pobr::imgProcessing::structs::Classifier;
+
+using BenchmarkApp = pobr::benchmark::BenchmarkApp;
+
+namespace
+{
+    // Nearest-rank percentile of sorted values
+    double getPercentile(const std::vector<double>& sortedValues, const double& percentile)
+    {
+        if (sortedValues.empty()) {
+            return 0;
+        }
+
+        const auto rank = std::ceil((percentile / 100) * sortedValues.size());
+        const auto idx = std::max<int64_t>(1, rank) - 1;
+
+        return sortedValues[std::min<int64_t>(idx, sortedValues.size() - 1)];
+    }
+}
+
+BenchmarkApp::BenchmarkApp(const std::vector<std::string>& arguments)
+{
+    try
+    {
+        auto cmdParser = CmdParser(arguments);
+
+        if (cmdParser.hasFlag("data")) {
+            this->config.dataPattern = cmdParser.getFlagValue("data");
+        }
+        if (cmdParser.hasFlag("scales")) {
+            this->config.scales = cmdParser.getPositiveIntegerListFlagValue("scales");
+        }
+        if (cmdParser.hasFlag("runs")) {
+            this->config.runs = cmdParser.getPositiveIntegerFlagValue("runs");
+        }
+        if (cmdParser.hasFlag("warmup")) {
+            this->config.warmupRuns = cmdParser.getNonNegativeIntegerFlagValue("warmup");
+        }
+        if (cmdParser.hasFlag("threads")) {
+            this->config.threadsCount = cmdParser.getPositiveIntegerFlagValue("threads");
+        }
+        if (cmdParser.hasFlag("prescan")) {
+            this->config.preScanFactor = cmdParser.getPositiveIntegerFlagValue("prescan");
+        }
+        if (cmdParser.hasFlag("output")) {
+            this->config.outputPath = cmdParser.getFlagValue("output");
+        }
+        if (cmdParser.hasFlag("model")) {
+            this->config.modelPath = cmdParser.getFlagValue("model");
+        }
+
+        if (!this->config.modelPath.empty()) {
+            Classifier::setModel(Classifier::fromFile(this->config.modelPath));
+        }
+
+        this->imgProcessor.setThreadsCount(this->config.threadsCount);
+
+        // Note: progress goes to stdout as well, so it's only shown when JSON does not
+        const bool isVerbose = !this->config.outputPath.empty();
+
+        std::vector<std::string> imgPaths;
+
+        cv::glob(this->config.dataPattern, imgPaths);
+        std::sort(imgPaths.begin(), imgPaths.end());
+
+        if (imgPaths.empty()) {
+            Logger::error("No images match \"" + this->config.dataPattern + "\"");
+        }
+
+        std::vector<ImageResult> results;
+
+        for (const auto& imgPath: imgPaths) {
+            const auto img = cv::imread(imgPath);
+
+            if (img.empty()) {
+                Logger::warning("Could not properly load image \"" + imgPath + "\"...");
+
+                continue;
+            }
+
+            for (const auto& scale: this->config.scales) {
+                if (isVerbose) {
+                    Logger::notice("Benchmarking \"" + imgPath + "\" at scale " + std::to_string(scale));
+                }
+
+                // Synthetic image: sample tiled scale x scale times, keeps content (and segment sizes)
+                // realistic while the resolution grows
+                const auto scaledImg = (scale == 1 ? img : cv::repeat(img, scale, scale));
+
+                results.push_back(this->benchmarkImage(imgPath, scaledImg, scale));
+            }
+        }
+
+        const auto json = this->toJSON(results);
+
+        if (this->config.outputPath.empty()) {
+            std::cout << json;
+        } else {
+            std::ofstream output(this->config.outputPath);
+
+            if (!output) {
+                Logger::error("Could not open \"" + this->config.outputPath + "\" for writing");
+            }
+
+            output << json;
+
+            Logger::notice("Results written to \"" + this->config.outputPath + "\"");
+        }
+    }
+    catch(Logger::Exception &e)
+    {
+        Logger::error("Terminating...", true);
+    }
+}
+
+const BenchmarkApp::ImageResult
+BenchmarkApp::benchmarkImage(
+    const std::string& name,
+    const cv::Mat& img,
+    const unsigned int& scale
+)
+{
+    ImageResult result;
+
+    result.image = name;
+    result.scale = scale;
+    result.width = img.cols;
+    result.height = img.rows;
+
+    auto& processor = this->imgProcessor;
+
+    processor.setImg(img);
+
+    // Inputs of each stage, so stages can be measured in isolation
+    const auto preEnhancedImg = processor.processPreEnhance(img);
+    const auto binarizedImg = processor.processBinarize(preEnhancedImg);
+    const auto enhancedImg = processor.processBinaryEnhance(binarizedImg);
+    const auto segments = processor.processSegmentation(enhancedImg);
+    const auto candidates = processor.processFilterCandidates(segments);
+
+    result.stages.push_back(this->measure("PreEnhance", [&]() { processor.processPreEnhance(img); }));
+    result.stages.push_back(this->measure("Binarize", [&]() { processor.processBinarize(preEnhancedImg); }));
+    result.stages.push_back(this->measure("BinaryEnhance", [&]() { processor.processBinaryEnhance(binarizedImg); }));
+    result.stages.push_back(this->measure("Segmentation", [&]() { processor.processSegmentation(enhancedImg); }));
+    result.stages.push_back(this->measure("FilterCandidates", [&]() { processor.processFilterCandidates(segments); }));
+    result.stages.push_back(this->measure("Detection", [&]() { processor.processDetection(candidates); }));
+    result.stages.push_back(this->measure("EndToEnd", [&]() { processor.process(false); }));
+
+    if (this->config.preScanFactor > 0) {
+        processor.setScanMethod(ImgProcessor::ScanMethod::CoarseToFine);
+        processor.setPreScanFactor(this->config.preScanFactor);
+
+        result.stages.push_back(this->measure("PreScan", [&]() { processor.processPreScan(img); }));
+        result.stages.push_back(this->measure("EndToEndCoarseToFine", [&]() { processor.process(false); }));
+
+        processor.setScanMethod(ImgProcessor::ScanMethod::Full);
+    }
+
+    return result;
+}
+
+const BenchmarkApp::StageResult
+BenchmarkApp::measure(
+    const std::string& stage,
+    const std::function<void()>& operation
+)
+const
+{
+    StageResult result;
+
+    result.stage = stage;
+
+    for (unsigned int run = 0; run < this->config.warmupRuns; run++) {
+        operation();
+    }
+
+    PerformanceTimer timer;
+
+    for (unsigned int run = 0; run < this->config.runs; run++) {
+        timer.start();
+        operation();
+        timer.stop();
+
+        result.durationsNS.push_back(timer.getDurationNS());
+    }
+
+    return result;
+}
+
+const std::string
+BenchmarkApp::toJSON(const std::vector<ImageResult>& results)
+const
+{
+    std::stringstream jsonStream;
+
+    jsonStream << std::fixed << std::setprecision(6);
+
+    jsonStream << "{\n";
+    jsonStream << "  \"config\": {\n";
+    jsonStream << "    \"data\": \"" << json::escape(this->config.dataPattern) << "\",\n";
+    jsonStream << "    \"runs\": " << this->config.runs << ",\n";
+    jsonStream << "    \"warmupRuns\": " << this->config.warmupRuns << ",\n";
+    jsonStream << "    \"threads\": " << this->imgProcessor.getThreadsCount() << "\n";
+    jsonStream << "  },\n";
+    jsonStream << "  \"results\": [";
+
+    for (size_t resultIdx = 0; resultIdx < results.size(); resultIdx++) {
+        const auto& result = results[resultIdx];
+
+        jsonStream << (resultIdx > 0 ? "," : "") << "\n";
+        jsonStream << "    {\n";
+        jsonStream << "      \"image\": \"" << json::escape(result.image) << "\",\n";
+        jsonStream << "      \"scale\": " << result.scale << ",\n";
+        jsonStream << "      \"width\": " << result.width << ",\n";
+        jsonStream << "      \"height\": " << result.height << ",\n";
+        jsonStream << "      \"stages\": {";
+
+        for (size_t stageIdx = 0; stageIdx < result.stages.size(); stageIdx++) {
+            const auto& stage = result.stages[stageIdx];
+            auto durations = stage.durationsNS;
+
+            std::sort(durations.begin(), durations.end());
+
+            double sum = 0;
+
+            for (const auto& duration: durations) {
+                sum += duration;
+            }
+
+            const double nsPerMs = 1000000;
+
+            jsonStream << (stageIdx > 0 ? "," : "") << "\n";
+            jsonStream << "        \"" << stage.stage << "\": { ";
+            jsonStream << "\"medianMs\": " << (getPercentile(durations, 50) / nsPerMs) << ", ";
+            jsonStream << "\"p99Ms\": " << (getPercentile(durations, 99) / nsPerMs) << ", ";
+            jsonStream << "\"minMs\": " << (durations.front() / nsPerMs) << ", ";
+            jsonStream << "\"meanMs\": " << ((sum / durations.size()) / nsPerMs) << " }";
+        }
+
+        jsonStream << "\n      }\n";
+        jsonStream << "    }";
+    }
+
+    jsonStream << "\n  ]\n";
+    jsonStream << "}\n";
+
+    return jsonStream.str();
+}
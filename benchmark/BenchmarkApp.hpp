@@ -0,0 +1,76 @@
+#ifndef POBR_BENCHMARK_BENCHMARKAPP_HPP
+#define POBR_BENCHMARK_BENCHMARKAPP_HPP
+
+#include <vector>
+#include <string>
+#include <functional>
+#include <opencv2/core/core.hpp>
+
+#include "../src/img-processing/ImgProcessor.hpp"
+
+namespace pobr::benchmark
+{
+    // Measures each ImgProcessor stage on its own and the whole pipeline,
+    // on sample images and their tiled (scaled up) versions, outputs JSON
+    //
+    // Flags:
+    //   --data=<pattern>   input images, defaults to "data/tesco_*.jpg"
+    //   --scales=<list>    tiling factors (NxN), defaults to "1,2,4"
+    //   --runs=<N>         measured runs per stage, defaults to 30
+    //   --warmup=<N>       unmeasured runs per stage, defaults to 3 (0 skips them)
+    //   --threads=<N>      ImgProcessor's threads count, defaults to one per CPU core
+    //   --prescan=<N>      also measures coarse-to-fine scans, with a pre-scan downscaled N times
+    //   --output=<path>    JSON destination, defaults to stdout
+    //   --model=<path>     classifier model, defaults to the built-in one (see models/tesco.txt)
+    class BenchmarkApp
+    {
+    public:
+        BenchmarkApp() = delete;
+        explicit BenchmarkApp(const std::vector<std::string>& arguments);
+
+    protected:
+        struct Config
+        {
+            std::string dataPattern = "data/tesco_*.jpg";
+            std::vector<unsigned int> scales = { 1, 2, 4 };
+            unsigned int runs = 30;
+            unsigned int warmupRuns = 3;
+            unsigned int threadsCount = 0;
+            unsigned int preScanFactor = 0;
+            std::string outputPath;
+            std::string modelPath;
+        };
+
+        struct StageResult
+        {
+            std::string stage;
+            std::vector<double> durationsNS;
+        };
+
+        struct ImageResult
+        {
+            std::string image;
+            unsigned int scale = 1;
+            int width = 0;
+            int height = 0;
+            std::vector<StageResult> stages;
+        };
+
+        Config config;
+        pobr::imgProcessing::ImgProcessor imgProcessor;
+
+        const ImageResult benchmarkImage(
+            const std::string& name,
+            const cv::Mat& img,
+            const unsigned int& scale
+        );
+        const StageResult measure(
+            const std::string& stage,
+            const std::function<void()>& operation
+        ) const;
+
+        const std::string toJSON(const std::vector<ImageResult>& results) const;
+    };
+}
+
+#endif
@@ -0,0 +1,15 @@
+#include <vector>
+#include <string>
+
+#include "./BenchmarkApp.hpp"
+
+using BenchmarkApp = pobr::benchmark::BenchmarkApp;
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> arguments(argv + 1, argv + argc);
+
+    BenchmarkApp myApp(arguments);
+
+    return 0;
+}
@@ -1,5 +1,6 @@
 #include "ImgProcessor.hpp"
 
+#include <algorithm>
 #include <opencv2/highgui/highgui.hpp>
 
 #include "../utils/consts.hpp"
@@ -22,6 +23,7 @@ namespace detection = pobr::imgProcessing::utils::detection;
 
 using Logger = pobr::utils::Logger;
 using PerformanceTimer = pobr::utils::PerformanceTimer;
+using ThreadPool = pobr::utils::ThreadPool;
 using ImgProcessor = pobr::imgProcessing::ImgProcessor;
 
 const bool
@@ -42,16 +44,81 @@ const
     Logger::error("ImgProcessor has no image loaded yet!");
 }
 
+const void
+ImgProcessor::setBinarizationMethod(const BinarizationMethod& method)
+{
+    this->binarizationMethod = method;
+
+    this->resetProducts();
+}
+
+const void
+ImgProcessor::setSegmentationMethod(const SegmentationMethod& method)
+{
+    this->segmentationMethod = method;
+
+    this->resetProducts();
+}
+
+const void
+ImgProcessor::setScanMethod(const ScanMethod& method)
+{
+    this->scanMethod = method;
+
+    this->resetProducts();
+}
+
+const void
+ImgProcessor::setPreScanFactor(const unsigned int& factor)
+{
+    this->preScanFactor = std::max(2u, factor);
+}
+
+const void
+ImgProcessor::setThreadsCount(const unsigned int& threadsCount)
+{
+    this->threadsCount = threadsCount;
+    this->threadPool.reset();
+}
+
+const unsigned int
+ImgProcessor::getThreadsCount()
+const
+{
+    return ThreadPool::resolveThreadsCount(this->threadsCount);
+}
+
+ThreadPool&
+ImgProcessor::getThreadPool()
+const
+{
+    if (!this->threadPool) {
+        this->threadPool = std::make_shared<ThreadPool>(this->threadsCount);
+    }
+
+    return *(this->threadPool);
+}
+
 const void
 ImgProcessor::loadImg(const std::string& imgPath)
 {
     this->img = cv::imread(imgPath);
 
+    this->resetProducts();
+
     if (this->img.empty()) {
         Logger::warning("Could not properly load image \"" + imgPath + "\"...");
     }
 }
 
+const void
+ImgProcessor::setImg(const cv::Mat& img)
+{
+    this->img = img;
+
+    this->resetProducts();
+}
+
 const cv::Mat&
 ImgProcessor::getImg()
 const
@@ -61,46 +128,240 @@ const
     return this->img;
 }
 
-const cv::Mat
-ImgProcessor::getBinarizedImg()
+const std::vector<structs::Segment>
+ImgProcessor::process(const bool& isProfiling)
+const
+{
+    this->assertIsReady();
+
+    // Always a fresh run, products are only kept for later use
+    this->resetProducts();
+
+    if (this->scanMethod == ScanMethod::CoarseToFine) {
+        const auto regions = this->processPreScan(this->img, isProfiling);
+
+        uint64_t regionsArea = 0;
+
+        for (const auto& region: regions) {
+            regionsArea += region.area();
+        }
+
+        // Note: not worth it when regions cover most of the image,
+        //       fall back to the full scan then
+        if (regionsArea <= (this->img.total() / 2)) {
+            return this->process(regions, isProfiling);
+        }
+    }
+
+    this->updateSegmentsProducts(isProfiling);
+
+    auto candidates = this->processFilterCandidates(this->products.segments, isProfiling);
+    auto letterSegments = this->processDetection(candidates, isProfiling);
+
+    return letterSegments;
+}
+
+const std::vector<structs::Segment>
+ImgProcessor::process(const cv::Rect& region, const bool& isProfiling, cv::Mat_<int>* segmentedImgOutput)
 const
 {
     this->assertIsReady();
 
-    auto img = this->img;
+    const auto clippedRegion = region & cv::Rect(0, 0, this->img.cols, this->img.rows);
 
-    img = this->processPreEnhance(img);
-    img = this->processBinarize(img);
-    img = this->processBinaryEnhance(img);
+    if (clippedRegion.area() == 0) {
+        return {};
+    }
+
+    if (segmentedImgOutput != nullptr) {
+        return this->processRegion(this->img, clippedRegion, isProfiling, segmentedImgOutput);
+    }
+
+    cv::Mat_<int> segmentedImg = this->scratch.getImg(
+        ScratchSlot::RegionSegmentedImgs,
+        clippedRegion.height,
+        clippedRegion.width,
+        CV_32SC1
+    );
 
-    return img;
+    return this->processRegion(this->img, clippedRegion, isProfiling, &segmentedImg);
 }
 
 const std::vector<structs::Segment>
-ImgProcessor::process()
+ImgProcessor::process(const std::vector<cv::Rect>& regions, const bool& isProfiling)
 const
 {
     this->assertIsReady();
 
-    auto img = this->img;
+    const cv::Rect imgBounds(0, 0, this->img.cols, this->img.rows);
+
+    std::vector<structs::Segment> letterSegments;
 
-    img = this->processPreEnhance(img, true);
-    img = this->processBinarize(img, true);
-    img = this->processBinaryEnhance(img, true);
+    for (size_t idx = 0; idx < regions.size(); idx++) {
+        const auto region = regions[idx] & imgBounds;
 
-    auto segments = this->processSegmentation(img, true);
-    auto candidates = this->processFilterCandidates(segments, true);
-    auto letterSegments = this->processDetection(candidates, true);
+        if (region.area() == 0) {
+            continue;
+        }
+
+        // Note: each region gets its own label image, as detections keep views of it
+        cv::Mat_<int> segmentedImg = this->scratch.getImg(
+            ScratchSlot::RegionSegmentedImgs + idx,
+            region.height,
+            region.width,
+            CV_32SC1
+        );
+
+        const auto regionLetterSegments = this->processRegion(this->img, region, isProfiling, &segmentedImg);
+
+        letterSegments.insert(
+            letterSegments.end(),
+            regionLetterSegments.begin(),
+            regionLetterSegments.end()
+        );
+    }
 
     return letterSegments;
 }
 
+const cv::Mat
+ImgProcessor::getEnhancedImg()
+const
+{
+    this->updateImgsProducts();
+
+    return this->products.enhancedImg;
+}
+
+const cv::Mat
+ImgProcessor::getBinarizedImg()
+const
+{
+    this->updateImgsProducts();
+
+    return this->products.binarizedImg;
+}
+
+const cv::Mat_<int>&
+ImgProcessor::getSegmentedImg()
+const
+{
+    this->updateSegmentsProducts();
+
+    return this->products.segmentedImg;
+}
+
+const std::vector<structs::Segment>&
+ImgProcessor::getSegments()
+const
+{
+    this->updateSegmentsProducts();
+
+    return this->products.segments;
+}
+
+const uint64_t
+ImgProcessor::getScratchBytes()
+const
+{
+    return this->scratch.getReservedBytes() + this->segmentationWorkspace.getReservedBytes();
+}
+
+const void
+ImgProcessor::releaseScratch()
+{
+    this->resetProducts();
+
+    this->scratch.release();
+    this->segmentationWorkspace.release();
+}
+
+const std::array<uint64_t, structs::Segment::filterStagesCount>&
+ImgProcessor::getFilterCounters()
+const
+{
+    return this->filterCounters;
+}
+
+const void
+ImgProcessor::resetFilterCounters()
+{
+    this->filterCounters = {};
+}
+
+const void
+ImgProcessor::resetProducts()
+const
+{
+    this->products = Products();
+}
+
+const void
+ImgProcessor::updateImgsProducts(const bool& isProfiling)
+const
+{
+    this->assertIsReady();
+
+    if (this->products.hasImgs) {
+        return;
+    }
+
+    auto& products = this->products;
+
+    const auto rows = this->img.rows;
+    const auto cols = this->img.cols;
+
+    products.enhancedImg = this->processPreEnhance(this->img, isProfiling);
+    products.binarizedImg = this->scratch.getImg(ScratchSlot::BinarizedImg, rows, cols, CV_8UC1);
+
+    this->processBinarize(products.enhancedImg, products.binarizedImg, isProfiling);
+    this->processBinaryEnhance(products.binarizedImg, products.binarizedImg, isProfiling);
+
+    products.hasImgs = true;
+}
+
+const void
+ImgProcessor::updateSegmentsProducts(const bool& isProfiling)
+const
+{
+    this->updateImgsProducts(isProfiling);
+
+    if (this->products.hasSegments) {
+        return;
+    }
+
+    auto& products = this->products;
+
+    products.segmentedImg = this->scratch.getImg(
+        ScratchSlot::SegmentedImg,
+        products.binarizedImg.rows,
+        products.binarizedImg.cols,
+        CV_32SC1
+    );
+    products.segments = this->processSegmentation(
+        products.binarizedImg,
+        isProfiling,
+        &(products.segmentedImg)
+    );
+    products.hasSegments = true;
+}
+
 cv::Mat
 ImgProcessor::processPreEnhance(const cv::Mat& img, const bool& isProfiling)
 const
 {
+    // Note: shares data with "img", so the disabled stage does not copy anything
     auto resultImg = img;
 
+    this->processPreEnhance(img, resultImg, isProfiling);
+
+    return resultImg;
+}
+
+const void
+ImgProcessor::processPreEnhance(const cv::Mat& img, cv::Mat& resultImg, const bool& isProfiling)
+const
+{
     PerformanceTimer profiler;
 
     profiler.start();
@@ -108,7 +369,11 @@ const
     // Note: disabled, as not needed
     //       supplied images are rather sharp
 
-    // resultImg = enhance::unsharpMasking(resultImg);
+    // enhance::unsharpMasking(img.clone(), resultImg);
+
+    if (resultImg.data != img.data) {
+        img.copyTo(resultImg);
+    }
 
     profiler.stop();
 
@@ -119,16 +384,23 @@ const
             std::string("ms")
         );
     }
-
-    return resultImg;
 }
 
 cv::Mat
 ImgProcessor::processBinarize(const cv::Mat& img, const bool& isProfiling)
 const
 {
-    auto resultImg = img;
+    cv::Mat resultImg;
+
+    this->processBinarize(img, resultImg, isProfiling);
+
+    return resultImg;
+}
 
+const void
+ImgProcessor::processBinarize(const cv::Mat& img, cv::Mat& resultImg, const bool& isProfiling)
+const
+{
     PerformanceTimer profiler;
 
     profiler.start();
@@ -143,15 +415,32 @@ const
     // );
     // resultImg = binarization::invertBinaryImage(resultImg);
 
-    resultImg = binarization::mixImageColors(
-        resultImg,
-        { -125, -140, 180 },
-        false
-    );
-    resultImg = binarization::binarizeImage(
-        resultImg,
-        50
-    );
+    const cv::Vec3i mixCoefficients = { -125, -140, 180 };
+    const unsigned int threshold = 50;
+
+    switch (this->binarizationMethod) {
+    case BinarizationMethod::ColorMixThreshold:
+        binarization::mixImageColors(
+            img,
+            mixCoefficients,
+            false,
+            resultImg
+        );
+        binarization::binarizeImage(
+            resultImg,
+            threshold,
+            resultImg
+        );
+        break;
+    case BinarizationMethod::FusedColorMixThreshold:
+        binarization::mixAndBinarizeImage(
+            img,
+            mixCoefficients,
+            threshold,
+            resultImg
+        );
+        break;
+    }
 
     profiler.stop();
 
@@ -162,16 +451,24 @@ const
             std::string("ms")
         );
     }
-
-    return resultImg;
 }
 
 cv::Mat
 ImgProcessor::processBinaryEnhance(const cv::Mat& img, const bool& isProfiling)
 const
 {
+    // Note: shares data with "img", so the disabled stage does not copy anything
     auto resultImg = img;
 
+    this->processBinaryEnhance(img, resultImg, isProfiling);
+
+    return resultImg;
+}
+
+const void
+ImgProcessor::processBinaryEnhance(const cv::Mat& img, cv::Mat& resultImg, const bool& isProfiling)
+const
+{
     PerformanceTimer profiler;
 
     profiler.start();
@@ -180,15 +477,20 @@ const
     //       1. not needed in here
     //       2. breaks some logos recognition
 
-    // resultImg = enhance::erodeImage(
-    //     resultImg,
+    // const auto erodedImg = enhance::erodeImage(
+    //     img,
     //     3
     // );
-    // resultImg = enhance::dilateImage(
-    //     resultImg,
-    //     3
+    // enhance::dilateImage(
+    //     erodedImg,
+    //     3,
+    //     resultImg
     // );
 
+    if (resultImg.data != img.data) {
+        img.copyTo(resultImg);
+    }
+
     profiler.stop();
 
     if (isProfiling) {
@@ -198,21 +500,39 @@ const
             std::string("ms")
         );
     }
-
-    return resultImg;
 }
 
 std::vector<structs::Segment>
-ImgProcessor::processSegmentation(const cv::Mat& img, const bool& isProfiling)
+ImgProcessor::processSegmentation(
+    const cv::Mat& img,
+    const bool& isProfiling,
+    cv::Mat_<int>* segmentedImgOutput
+)
 const
 {
     auto resultImg = img;
+    auto workspace = &(this->segmentationWorkspace);
 
     PerformanceTimer profiler;
 
     profiler.start();
 
-    auto segments = segmentation::getImageSegmentsFloodFill(resultImg, false);
+    std::vector<structs::Segment> segments;
+
+    switch (this->segmentationMethod) {
+    case SegmentationMethod::FloodFill:
+        segments = segmentation::getImageSegmentsFloodFill(resultImg, false, segmentedImgOutput, workspace);
+        break;
+    case SegmentationMethod::UnionFind:
+        segments = segmentation::getImageSegmentsUnionFind(resultImg, false, segmentedImgOutput, workspace, &(this->getThreadPool()));
+        break;
+    case SegmentationMethod::ParallelUnionFind:
+        segments = segmentation::getImageSegmentsUnionFindParallel(resultImg, this->getThreadPool(), false, segmentedImgOutput, workspace);
+        break;
+    case SegmentationMethod::ScanMerge:
+        segments = segmentation::getImageSegmentsScanMerge(resultImg, false, segmentedImgOutput, workspace, &(this->getThreadPool()));
+        break;
+    }
 
     profiler.stop();
 
@@ -239,8 +559,11 @@ const
     profiler.start();
 
     std::vector<structs::Segment> filteredSegments;
+    std::array<uint64_t, structs::Segment::filterStagesCount> counters = {};
 
     for (auto& segment: segments) {
+        counters[(size_t) segment.getFilterStage()]++;
+
         if (!segment.isClassifiedAsLetter()) {
             continue;
         }
@@ -248,6 +571,10 @@ const
         filteredSegments.push_back(segment);
     }
 
+    for (size_t idx = 0; idx < counters.size(); idx++) {
+        this->filterCounters[idx] += counters[idx];
+    }
+
     profiler.stop();
 
     if (isProfiling) {
@@ -256,6 +583,16 @@ const
             std::to_string(profiler.getDurationNS() / 1000000) +
             std::string("ms")
         );
+
+        std::string rejections;
+
+        for (size_t idx = 0; idx < counters.size(); idx++) {
+            rejections += (idx > 0 ? ", " : "");
+            rejections += structs::Segment::getFilterStageName((structs::Segment::FilterStage) idx);
+            rejections += ": " + std::to_string(counters[idx]);
+        }
+
+        Logger::notice(std::string("FilterCandidates rejections per check: ") + rejections);
     }
 
     return filteredSegments;
@@ -287,6 +624,154 @@ const
     return groupedSegments;
 }
 
+std::vector<cv::Rect>
+ImgProcessor::processPreScan(const cv::Mat& img, const bool& isProfiling)
+const
+{
+    PerformanceTimer profiler;
+
+    profiler.start();
+
+    const uint64_t factor = this->preScanFactor;
+
+    const int coarseRows = img.rows / factor;
+    const int coarseCols = img.cols / factor;
+
+    auto coarseImg = this->scratch.getImg(ScratchSlot::CoarseImg, coarseRows, coarseCols, CV_8UC3);
+    auto coarseBinarizedImg = this->scratch.getImg(ScratchSlot::CoarseBinarizedImg, coarseRows, coarseCols, CV_8UC1);
+    cv::Mat_<int> coarseSegmentedImg = this->scratch.getImg(ScratchSlot::CoarseSegmentedImg, coarseRows, coarseCols, CV_32SC1);
+
+    converters::downscaleImage(img, factor, coarseImg);
+
+    this->processPreEnhance(coarseImg, coarseImg);
+    this->processBinarize(coarseImg, coarseBinarizedImg);
+    this->processBinaryEnhance(coarseBinarizedImg, coarseBinarizedImg);
+
+    const auto coarseSegments = this->processSegmentation(coarseBinarizedImg, false, &coarseSegmentedImg);
+
+    // Note: letters may merge with each other (or lose thin strokes) when downscaled,
+    //       so area bounds are loose, anything from half a letter up to a whole logo,
+    //       and a region is kept only if its segments make up at least half of a logo
+    const uint64_t lettersCount = 5;
+    const uint64_t minArea = structs::Segment::minLetterArea / 2;
+    const uint64_t maxArea = 2 * lettersCount * structs::Segment::maxLetterArea;
+    const uint64_t minRegionArea = lettersCount * minArea;
+
+    const cv::Rect imgBounds(0, 0, img.cols, img.rows);
+
+    std::vector<cv::Rect> regions;
+    std::vector<uint64_t> regionsAreas;
+
+    for (const auto& segment: coarseSegments) {
+        const uint64_t area = segment.getArea() * factor * factor;
+
+        if (area < minArea || area > maxArea) {
+            continue;
+        }
+
+        const int x = segment.xMin * factor;
+        const int y = segment.yMin * factor;
+        const int width = segment.getWidth() * factor;
+        const int height = segment.getHeight() * factor;
+
+        // Letters of a logo lie side by side, detection looks for the rest of them
+        // within a few letter widths, so regions of neighbours overlap and get merged below
+        const int marginX = (2 * std::max(width, height)) + factor;
+        const int marginY = height + factor;
+
+        regions.push_back(
+            cv::Rect(
+                x - marginX,
+                y - marginY,
+                width + (2 * marginX),
+                height + (2 * marginY)
+            ) & imgBounds
+        );
+        regionsAreas.push_back(area);
+    }
+
+    std::vector<size_t> mergedRegionsIdxs;
+
+    const auto mergedRegions = detection::mergeRegions(regions, &mergedRegionsIdxs);
+
+    // Total area of segments within each of the merged regions
+    std::vector<uint64_t> mergedRegionsAreas(mergedRegions.size(), 0);
+
+    for (size_t idx = 0; idx < regions.size(); idx++) {
+        mergedRegionsAreas[mergedRegionsIdxs[idx]] += regionsAreas[idx];
+    }
+
+    std::vector<cv::Rect> plausibleRegions;
+
+    for (size_t idx = 0; idx < mergedRegions.size(); idx++) {
+        if (mergedRegionsAreas[idx] < minRegionArea) {
+            continue;
+        }
+
+        plausibleRegions.push_back(mergedRegions[idx]);
+    }
+
+    profiler.stop();
+
+    if (isProfiling) {
+        Logger::notice(
+            std::string("PreScan phase took: ") +
+            std::to_string(profiler.getDurationNS() / 1000000) +
+            std::string("ms (") +
+            std::to_string(plausibleRegions.size()) +
+            std::string(" regions)")
+        );
+    }
+
+    return plausibleRegions;
+}
+
+std::vector<structs::Segment>
+ImgProcessor::processRegion(
+    const cv::Mat& img,
+    const cv::Rect& region,
+    const bool& isProfiling,
+    cv::Mat_<int>* segmentedImgOutput
+)
+const
+{
+    PerformanceTimer profiler;
+
+    profiler.start();
+
+    // Note: a view, stages work row by row so there is no need for a copy
+    const auto regionImg = img(region);
+    const auto enhancedImg = this->processPreEnhance(regionImg);
+
+    auto binarizedImg = this->scratch.getImg(ScratchSlot::RegionBinarizedImg, region.height, region.width, CV_8UC1);
+
+    this->processBinarize(enhancedImg, binarizedImg);
+    this->processBinaryEnhance(binarizedImg, binarizedImg);
+
+    const auto segments = this->processSegmentation(binarizedImg, false, segmentedImgOutput);
+    const auto candidates = this->processFilterCandidates(segments);
+
+    auto letterSegments = this->processDetection(candidates);
+
+    for (auto& segment: letterSegments) {
+        segment.translate(region.x, region.y);
+    }
+
+    profiler.stop();
+
+    if (isProfiling) {
+        Logger::notice(
+            std::string("Region (") +
+            std::to_string(region.width) + "x" + std::to_string(region.height) +
+            std::string(") phase took: ") +
+            std::to_string(profiler.getDurationNS() / 1000000) +
+            std::string("ms")
+        );
+    }
+
+    return letterSegments;
+}
+
 cv::Mat
 ImgProcessor::drawSegmentsBBoxes(
     const cv::Mat& img,
@@ -294,9 +779,13 @@ ImgProcessor::drawSegmentsBBoxes(
     const cv::Vec3b& borderColor,
     const unsigned int& borderSize
 )
-const
 {
-    auto resultImg = img.clone();
+    // Note: binary images are single-channel, expand them so borders can be colored
+    auto resultImg = (
+        img.channels() == 1 ?
+        converters::expandGrayscaleImage(img) :
+        img.clone()
+    );
 
     for (auto& segment: segments) {
         for (int64_t x = segment.xMin - borderSize; x < segment.xMin; x++) {
@@ -1,11 +1,16 @@
 #ifndef POBR_IMGPROCESSING_IMGPROCESSOR_HPP
 #define POBR_IMGPROCESSING_IMGPROCESSOR_HPP
 
+#include <array>
 #include <string>
 #include <vector>
+#include <memory>
 #include <opencv2/core/core.hpp>
 
+#include "../utils/thread-pool/ThreadPool.hpp"
 #include "./structs/Segment.hpp"
+#include "./structs/ScratchArena.hpp"
+#include "./utils/segmentation.hpp"
 
 namespace structs = pobr::imgProcessing::structs;
 
@@ -14,40 +19,138 @@ namespace pobr::imgProcessing
     class ImgProcessor
     {
     public:
+        enum class BinarizationMethod
+        {
+            // Color mixer pass followed by a thresholding pass
+            ColorMixThreshold,
+            // Both in a single integer / SIMD pass, with the same result
+            FusedColorMixThreshold
+        };
+
+        enum class SegmentationMethod
+        {
+            // Stack-based flood fill, kept as the reference implementation
+            FloodFill,
+            // Two-pass union-find labelling, same segments
+            UnionFind,
+            // Union-find labelling of image strips on multiple threads, same segments
+            ParallelUnionFind,
+            // Run-length scanline segmentation, same segments
+            ScanMerge
+        };
+
+        enum class ScanMethod
+        {
+            // Whole pipeline on every pixel of the image
+            Full,
+            // Pipeline on a downscaled image first, then in full resolution
+            // but only within regions around plausible letter clusters found there
+            CoarseToFine
+        };
+
+        const void setBinarizationMethod(const BinarizationMethod& method);
+        const void setSegmentationMethod(const SegmentationMethod& method);
+        const void setScanMethod(const ScanMethod& method);
+        // Downscaling factor of the coarse scan, values below 2 are treated as 2
+        const void setPreScanFactor(const unsigned int& factor);
+        // "0" means one thread per CPU core
+        // Note: threads are only started by the first run needing them
+        const void setThreadsCount(const unsigned int& threadsCount);
+        const unsigned int getThreadsCount() const;
+
         const void loadImg(const std::string& imgPath);
+        // Note: keeps a header of "img" (data is shared, not copied)
+        const void setImg(const cv::Mat& img);
         const cv::Mat& getImg() const;
+        // Runs the whole pipeline, keeping its products (see below) until the image
+        // or any of the methods change
+        // Note: coarse-to-fine scans keep no products, as they never process the whole image
+        // Note: intermediate images live in scratch memory reused by the next run,
+        //       so label views of returned segments (and products) are only valid until then,
+        //       unless copied (see Segment::detachLabelsView)
+        const std::vector<structs::Segment> process(const bool& isProfiling = true) const;
+        // Runs the whole pipeline within a region of the image only (see processRegion),
+        // into a scratch label image unless segmentedImgOutput is given
+        const std::vector<structs::Segment> process(
+            const cv::Rect& region,
+            const bool& isProfiling = true,
+            cv::Mat_<int>* segmentedImgOutput = nullptr
+        ) const;
+        // Same as above, for each of the regions (clipped to the image), with results joined
+        // Note: regions are expected to be disjoint, letters within an overlap
+        //       of two regions would be detected twice
+        const std::vector<structs::Segment> process(
+            const std::vector<cv::Rect>& regions,
+            const bool& isProfiling = true
+        ) const;
+
+        // Products of the last run, computed (and kept) on first use if there was none
+        // Note: not thread-safe, use one ImgProcessor per thread
+        const cv::Mat getEnhancedImg() const;
         const cv::Mat getBinarizedImg() const;
-        const std::vector<structs::Segment> process() const;
+        const cv::Mat_<int>& getSegmentedImg() const;
+        const std::vector<structs::Segment>& getSegments() const;
+
+        // Memory kept for reuse by runs (grows up to what the largest image needed so far)
+        const uint64_t getScratchBytes() const;
+        const void releaseScratch();
+
+        // Numbers of segments rejected by each of the classification checks
+        // (indexed by Segment::FilterStage, the last ones are letters),
+        // summed over all candidates filtered since the last reset
+        // Note: coarse scans' segments (see setPreScanFactor) are never filtered,
+        //       so only the full resolution ones are counted
+        const std::array<uint64_t, structs::Segment::filterStagesCount>& getFilterCounters() const;
+        const void resetFilterCounters();
 
-        cv::Mat drawSegmentsBBoxes(
+        // Note: uses no processor's state, so any thread can draw without one
+        static cv::Mat drawSegmentsBBoxes(
             const cv::Mat& img,
             const std::vector<structs::Segment>& segments,
             const cv::Vec3b& borderColor = { 0, 0, 0 },
             const unsigned int& borderSize = 1
-        ) const;
-
-    protected:
-        cv::Mat img;
-
-        const bool isReady() const;
-        const void assertIsReady() const;
+        );
 
+        // Pipeline stages, in order of application, used by process()
+        // but also usable on their own (eg. for benchmarking)
+        // Note: overloads taking "resultImg" write into it, allocating only if its size
+        //       or type differs (see cv::Mat::create), so it can be a reused buffer or a view
         cv::Mat processPreEnhance(
             const cv::Mat& img,
             const bool& isProfiling = false
         ) const;
+        // Note: can be applied in place (with "resultImg" sharing data with "img")
+        const void processPreEnhance(
+            const cv::Mat& img,
+            cv::Mat& resultImg,
+            const bool& isProfiling = false
+        ) const;
         cv::Mat processBinarize(
             const cv::Mat& img,
             const bool& isProfiling = false
         ) const;
+        const void processBinarize(
+            const cv::Mat& img,
+            cv::Mat& resultImg,
+            const bool& isProfiling = false
+        ) const;
         cv::Mat processBinaryEnhance(
             const cv::Mat& img,
             const bool& isProfiling = false
         ) const;
-        std::vector<structs::Segment> processSegmentation(
+        // Note: can be applied in place (with "resultImg" sharing data with "img")
+        const void processBinaryEnhance(
             const cv::Mat& img,
+            cv::Mat& resultImg,
             const bool& isProfiling = false
         ) const;
+        // Note: keeps its working memory in scratch, the label image is allocated
+        //       unless segmentedImgOutput is given
+        std::vector<structs::Segment> processSegmentation(
+            const cv::Mat& img,
+            const bool& isProfiling = false,
+            cv::Mat_<int>* segmentedImgOutput = nullptr
+        ) const;
         std::vector<structs::Segment> processFilterCandidates(
             const std::vector<structs::Segment>& segments,
             const bool& isProfiling = false
@@ -56,6 +159,74 @@ namespace pobr::imgProcessing
             const std::vector<structs::Segment>& segments,
             const bool& isProfiling = false
         ) const;
+
+        // Coarse scan of the coarse-to-fine mode, returns (disjoint) regions of the image
+        // worth a full resolution scan, clipped to its bounds
+        std::vector<cv::Rect> processPreScan(
+            const cv::Mat& img,
+            const bool& isProfiling = false
+        ) const;
+        // Whole pipeline within a region of any image (eg. an externally owned frame),
+        // working on a view of it, detections are placed in image coordinates
+        // Note: label image is written into segmentedImgOutput when given (see processSegmentation),
+        //       so with the same buffer passed each time, steady-state calls only allocate segments
+        std::vector<structs::Segment> processRegion(
+            const cv::Mat& img,
+            const cv::Rect& region,
+            const bool& isProfiling = false,
+            cv::Mat_<int>* segmentedImgOutput = nullptr
+        ) const;
+
+    protected:
+        // Slots of scratch images, region label images take consecutive slots from RegionSegmentedImgs
+        enum ScratchSlot: size_t
+        {
+            BinarizedImg,
+            SegmentedImg,
+            CoarseImg,
+            CoarseBinarizedImg,
+            CoarseSegmentedImg,
+            RegionBinarizedImg,
+            RegionSegmentedImgs
+        };
+
+        struct Products
+        {
+            cv::Mat enhancedImg;
+            cv::Mat binarizedImg;
+            cv::Mat_<int> segmentedImg;
+            std::vector<structs::Segment> segments;
+
+            bool hasImgs = false;
+            bool hasSegments = false;
+        };
+
+        cv::Mat img;
+
+        // Note: a cache, so it can be filled by const methods
+        mutable Products products;
+        // Note: products' images are views of scratch images
+        mutable structs::ScratchArena scratch;
+        mutable pobr::imgProcessing::utils::segmentation::Workspace segmentationWorkspace;
+        mutable std::array<uint64_t, structs::Segment::filterStagesCount> filterCounters = {};
+
+        BinarizationMethod binarizationMethod = BinarizationMethod::FusedColorMixThreshold;
+        SegmentationMethod segmentationMethod = SegmentationMethod::ParallelUnionFind;
+        ScanMethod scanMethod = ScanMethod::Full;
+        unsigned int preScanFactor = 4;
+
+        unsigned int threadsCount = 0;
+        // Note: created on first use (see getThreadPool), shared by copies
+        mutable std::shared_ptr<pobr::utils::ThreadPool> threadPool;
+
+        const bool isReady() const;
+        const void assertIsReady() const;
+
+        pobr::utils::ThreadPool& getThreadPool() const;
+
+        const void resetProducts() const;
+        const void updateImgsProducts(const bool& isProfiling = false) const;
+        const void updateSegmentsProducts(const bool& isProfiling = false) const;
     };
 }
 
@@ -0,0 +1,541 @@
+#include "Classifier.hpp"
+
+#include <cmath>
+#include <limits>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+
+#include "../../utils/logger/Logger.hpp"
+
+using Logger = pobr::utils::Logger;
+using Classifier = pobr::imgProcessing::structs::Classifier;
+
+namespace
+{
+    // Same as models/tesco.txt
+    const char* const defaultModel = R"(
+word TESCO
+max-distance 2.5
+
+class T
+    0.434774786 2.11425352 1.33718228 3.32388353 5.2270565 4.71922636 1.52873135
+    0.00693699438 0.0465741679 0.017515149 0.059875045 0.0513869673 0.0970803127 0.00714537734
+    0.0465741679 0.376308441 0.114306368 0.426829219 0.752581596 0.697139978 0.0458640829
+    0.017515149 0.114306368 0.0466330275 0.151671499 0.0648072138 0.251560628 0.0188605804
+    0.059875045 0.426829219 0.151671499 0.610673547 0.473097086 0.988508642 0.0609353669
+    0.0513869673 0.752581596 0.0648072138 0.473097086 10.8078527 0.00270180334 0.0143349282
+    0.0970803127 0.697139978 0.251560628 0.988508642 0.00270180334 1.85047865 0.101279639
+    0.00714537734 0.0458640829 0.0188605804 0.0609353669 0.0143349282 0.101279639 0.00784669071
+
+class E
+    0.499075741 1.95125091 2.92028236 4.29834127 -5.66691351 -3.68041968 1.68046141
+    0.00879216846 0.0445979722 0.0396706834 0.0549608357 -0.143990844 -0.102583714 0.0095969392
+    0.0445979722 0.247503191 0.206907094 0.269571841 -0.740561187 -0.530639052 0.0472958609
+    0.0396706834 0.206907094 0.200130656 0.263328969 -0.778732717 -0.547648668 0.0436829776
+    0.0549608357 0.269571841 0.263328969 0.483787805 -1.24689722 -0.885992646 0.0620671622
+    -0.143990844 -0.740561187 -0.778732717 -1.24689722 6.01127815 3.98746896 -0.150327951
+    -0.102583714 -0.530639052 -0.547648668 -0.885992646 3.98746896 2.72705173 -0.108544178
+    0.0095969392 0.0472958609 0.0436829776 0.0620671622 -0.150327951 -0.108544178 0.0111690564
+
+class S
+    0.502896488 2.3233819 4.01436758 5.10291147 3.42926383 -4.60246801 1.65342343
+    0.00577596482 0.0426223464 0.0189174339 0.0335177034 -0.105645441 -0.174968556 0.00721698254
+    0.0426223464 0.361426473 0.13058342 0.188829884 -0.963549256 -1.43661499 0.0507223643
+    0.0189174339 0.13058342 0.260235488 0.199485242 -0.0909977853 -0.194805801 0.0259373486
+    0.0335177034 0.188829884 0.199485242 0.549858987 -0.320634305 -1.46192205 0.046468284
+    -0.105645441 -0.963549256 -0.0909977853 -0.320634305 81.9304504 -1.02525473 -0.187203929
+    -0.174968556 -1.43661499 -0.194805801 -1.46192205 -1.02525473 20.7484436 -0.20368892
+    0.00721698254 0.0507223643 0.0259373486 0.046468284 -0.187203929 -0.20368892 0.00984544121
+
+class C
+    0.392978042 2.35839772 1.91748154 3.47740483 -3.93454695 -3.49217844 1.42489135
+    0.00518115563 0.0464367867 0.0225465596 0.040994186 -0.104200877 -0.0292465854 0.00626000157
+    0.0464367867 0.516113281 0.211404115 0.420706451 -0.847079635 -0.304167718 0.0538212471
+    0.0225465596 0.211404115 0.10209135 0.187014535 -0.438462287 -0.133476838 0.0275680907
+    0.040994186 0.420706451 0.187014535 0.387326688 -0.845063031 -0.242222369 0.0472666845
+    -0.104200877 -0.847079635 -0.438462287 -0.845063031 4.16258335 0.44197619 -0.129849702
+    -0.0292465854 -0.304167718 -0.133476838 -0.242222369 0.44197619 0.2034159 -0.0362568274
+    0.00626000157 0.0538212471 0.0275680907 0.0472666845 -0.129849702 -0.0362568274 0.00818475429
+
+class O
+    0.450861096 2.19461489 4.948946 5.54003 4.82778835 2.32500792 1.53018332
+    0.00249999994 0.00681945821 0.00330355391 0.0100346357 0.0836254209 -0.0248353835 0.00463623973
+    0.00681945821 0.0842065811 0.0123880608 -0.00258190371 0.0920304731 0.286019176 0.010267457
+    0.00330355391 0.0123880608 0.21155484 0.246280149 -1.65865076 -0.479596287 0.00629505189
+    0.0100346357 -0.00258190371 0.246280149 0.657703102 -4.50361061 -0.0608285442 0.0220665783
+    0.0836254209 0.0920304731 -1.65865076 -4.50361061 97.3174515 3.77406788 0.137246564
+    -0.0248353835 0.286019176 -0.479596287 -0.0608285442 3.77406788 41.9732895 -0.0637867004
+    0.00463623973 0.010267457 0.00629505189 0.0220665783 0.137246564 -0.0637867004 0.0090971496
+)";
+
+    // Inverse of the lower triangular Cholesky factor of covariances, as entries row by row,
+    // empty unless covariances are symmetric and positive-definite
+    const std::vector<float>
+    getWhitening(const std::array<Classifier::Features, Classifier::invariantsCount>& covariances)
+    {
+        const uint8_t size = Classifier::invariantsCount;
+
+        std::array<std::array<double, size>, size> factor = {};
+        std::array<std::array<double, size>, size> inverse = {};
+
+        for (uint8_t row = 0; row < size; row++) {
+            for (uint8_t column = 0; column <= row; column++) {
+                if (covariances[row][column] != covariances[column][row]) {
+                    return {};
+                }
+
+                double value = covariances[row][column];
+
+                for (uint8_t no = 0; no < column; no++) {
+                    value -= factor[row][no] * factor[column][no];
+                }
+
+                if (row != column) {
+                    factor[row][column] = value / factor[column][column];
+                } else if (value > 0) {
+                    factor[row][column] = std::sqrt(value);
+                } else {
+                    return {};
+                }
+            }
+        }
+
+        // Note: forward substitution, one column of the identity at a time
+        for (uint8_t column = 0; column < size; column++) {
+            for (uint8_t row = column; row < size; row++) {
+                double value = (row == column ? 1 : 0);
+
+                for (uint8_t no = column; no < row; no++) {
+                    value -= factor[row][no] * inverse[no][column];
+                }
+
+                inverse[row][column] = value / factor[row][row];
+            }
+        }
+
+        std::vector<float> whitening;
+
+        for (uint8_t row = 0; row < size; row++) {
+            for (uint8_t column = 0; column <= row; column++) {
+                whitening.push_back(inverse[row][column]);
+            }
+        }
+
+        return whitening;
+    }
+
+    // Values separated by spaces, with enough digits to read back as the very same ones
+    const std::string
+    formatRow(const Classifier::Features& values)
+    {
+        std::stringstream row;
+
+        row << std::setprecision(std::numeric_limits<float>::max_digits10);
+
+        for (uint8_t no = 0; no < values.size(); no++) {
+            row << (no > 0 ? " " : "") << values[no];
+        }
+
+        return row.str();
+    }
+
+    const Classifier loadDefaultModel()
+    {
+        std::istringstream input(defaultModel);
+
+        return Classifier::fromStream(input, "built-in");
+    }
+
+    Classifier& getModelStorage()
+    {
+        static Classifier model = loadDefaultModel();
+
+        return model;
+    }
+}
+
+const Classifier::Features
+Classifier::toFeatures(const std::array<double, invariantsCount>& huInvariants)
+{
+    Features features;
+
+    for (uint8_t no = 0; no < Classifier::invariantsCount; no++) {
+        features[no] = Classifier::toFeature(huInvariants[no]);
+    }
+
+    return features;
+}
+
+const float
+Classifier::toFeature(const double& huInvariant)
+{
+    const double magnitude = std::max(std::abs(huInvariant), std::numeric_limits<double>::epsilon());
+
+    return (huInvariant < 0 ? 1 : -1) * std::log10(magnitude);
+}
+
+const Classifier
+Classifier::fromFile(const std::string& path)
+{
+    std::ifstream input(path);
+
+    if (!input.is_open()) {
+        Logger::error("Could not open classifier model \"" + path + "\"");
+    }
+
+    return Classifier::fromStream(input, path);
+}
+
+const Classifier
+Classifier::fromStream(std::istream& input, const std::string& sourceName)
+{
+    const auto fail = [&](const std::string& reason) -> void
+    {
+        Logger::error("Invalid classifier model \"" + sourceName + "\": " + reason);
+    };
+
+    std::vector<std::string> tokens;
+    std::string line;
+
+    while (std::getline(input, line)) {
+        std::istringstream lineStream(line.substr(0, line.find('#')));
+        std::string token;
+
+        while (lineStream >> token) {
+            tokens.push_back(token);
+        }
+    }
+
+    // Note: parsed as double, which rounds values written by write() to the same floats
+    const auto parseNumber = [&](const size_t& idx) -> double
+    {
+        char* end = nullptr;
+        const double number = std::strtod(tokens[idx].c_str(), &end);
+
+        if (end == tokens[idx].c_str() || *end != '\0' || !std::isfinite(number)) {
+            fail("\"" + tokens[idx] + "\" is not a number");
+        }
+
+        return number;
+    };
+
+    std::string word;
+    double maxDistance = 0;
+    std::vector<char> classLetters;
+    std::vector<Centroid> classCentroids;
+
+    for (size_t idx = 0; idx < tokens.size();) {
+        const auto keyword = tokens[idx++];
+
+        if (keyword == "word" || keyword == "max-distance") {
+            if (idx >= tokens.size()) {
+                fail("missing value of \"" + keyword + "\"");
+            }
+
+            if (keyword == "word") {
+                word = tokens[idx];
+            } else {
+                maxDistance = parseNumber(idx);
+            }
+
+            idx++;
+
+            continue;
+        }
+
+        if (keyword != "class") {
+            fail("unexpected \"" + keyword + "\"");
+        }
+        if (idx + 1 + ((1 + Classifier::invariantsCount) * Classifier::invariantsCount) > tokens.size()) {
+            fail("incomplete class");
+        }
+
+        const auto letter = tokens[idx++];
+
+        if (letter.size() != 1) {
+            fail("class \"" + letter + "\" is not a single letter");
+        }
+
+        Centroid centroid;
+
+        for (auto& mean: centroid.means) {
+            mean = parseNumber(idx++);
+        }
+        for (auto& covariancesRow: centroid.covariances) {
+            for (auto& covariance: covariancesRow) {
+                covariance = parseNumber(idx++);
+            }
+        }
+
+        classLetters.push_back(letter[0]);
+        classCentroids.push_back(centroid);
+    }
+
+    return Classifier::fromCentroids(word, classLetters, classCentroids, maxDistance, sourceName);
+}
+
+const Classifier
+Classifier::fromCentroids(
+    const std::string& word,
+    const std::vector<char>& classLetters,
+    const std::vector<Centroid>& classCentroids,
+    const double& maxDistance,
+    const std::string& sourceName
+)
+{
+    const auto fail = [&](const std::string& reason) -> void
+    {
+        Logger::error("Invalid classifier model \"" + sourceName + "\": " + reason);
+    };
+
+    if (classLetters.empty()) {
+        fail("no classes");
+    }
+    if (classLetters.size() > Classifier::maxClassesCount) {
+        fail("more than " + std::to_string(Classifier::maxClassesCount) + " classes");
+    }
+    if (classLetters.size() != classCentroids.size()) {
+        fail("centroids of " + std::to_string(classCentroids.size()) + " classes given for " + std::to_string(classLetters.size()));
+    }
+    if (word.size() < 2) {
+        fail("word of at least two letters expected");
+    }
+    if (!(maxDistance > 0)) {
+        fail("positive max-distance expected");
+    }
+
+    Classifier classifier;
+
+    // Note: any feature of a classified segment is within this many deviations of class' mean,
+    //       as its squared distance is at most (invariantsCount * maxDistance^2)
+    const double maxFeatureDistance = std::sqrt((double) Classifier::invariantsCount) * maxDistance;
+    // Keeps float rounding of classify() from getting past spans
+    const float spanMargin = 0.001;
+
+    classifier.maxDistance = maxDistance;
+    classifier.centroids = classCentroids;
+
+    for (size_t classIdx = 0; classIdx < classLetters.size(); classIdx++) {
+        const auto letter = std::string(1, classLetters[classIdx]);
+        const auto& centroid = classCentroids[classIdx];
+
+        if (std::find(classLetters.begin(), classLetters.begin() + classIdx, letter[0]) != classLetters.begin() + classIdx) {
+            fail("class \"" + letter + "\" defined twice");
+        }
+
+        const auto whitening = getWhitening(centroid.covariances);
+
+        if (whitening.empty()) {
+            fail("covariances of class \"" + letter + "\" are not symmetric and positive-definite");
+        }
+
+        for (uint8_t entry = 0; entry < Classifier::whiteningsCount; entry++) {
+            classifier.whitenings[entry].push_back(whitening[entry]);
+        }
+
+        for (uint8_t no = 0; no < Classifier::invariantsCount; no++) {
+            const auto& mean = centroid.means[no];
+            const double deviation = std::sqrt(centroid.covariances[no][no]);
+
+            classifier.means[no].push_back(mean);
+
+            const std::pair<float, float> span = {
+                mean - (maxFeatureDistance * deviation) - spanMargin,
+                mean + (maxFeatureDistance * deviation) + spanMargin
+            };
+
+            if (classIdx == 0) {
+                classifier.spans[no] = span;
+            } else {
+                classifier.spans[no].first = std::min(classifier.spans[no].first, span.first);
+                classifier.spans[no].second = std::max(classifier.spans[no].second, span.second);
+            }
+        }
+    }
+
+    classifier.classLetters = classLetters;
+
+    for (const auto& letter: word) {
+        const auto classIt = std::find(classLetters.begin(), classLetters.end(), letter);
+
+        if (classIt == classLetters.end()) {
+            fail("no class of word's letter \"" + std::string(1, letter) + "\"");
+        }
+
+        classifier.word.push_back(classIt - classLetters.begin());
+    }
+
+    return classifier;
+}
+
+const void
+Classifier::write(std::ostream& output)
+const
+{
+    const auto precision = output.precision();
+
+    output << "word ";
+
+    for (const auto& classIdx: this->word) {
+        output << this->classLetters[classIdx];
+    }
+
+    output << "\n";
+
+    // Note: enough digits for numbers to read back as the very same ones
+    output << std::setprecision(std::numeric_limits<double>::max_digits10);
+    output << "max-distance " << this->maxDistance << "\n";
+    output << std::setprecision(precision);
+
+    for (size_t classIdx = 0; classIdx < this->classLetters.size(); classIdx++) {
+        output << "\nclass " << this->classLetters[classIdx] << "\n";
+
+        const auto& centroid = this->centroids[classIdx];
+
+        output << "    " << formatRow(centroid.means) << "\n";
+
+        for (const auto& covariancesRow: centroid.covariances) {
+            output << "    " << formatRow(covariancesRow) << "\n";
+        }
+    }
+}
+
+const Classifier&
+Classifier::getModel()
+{
+    return getModelStorage();
+}
+
+const void
+Classifier::setModel(const Classifier& model)
+{
+    getModelStorage() = model;
+}
+
+const Classifier::Prefilter
+Classifier::skipChecks(const Prefilter& prefilter, const std::string& checks)
+{
+    auto result = prefilter;
+
+    std::istringstream checksStream(checks);
+    std::string check;
+
+    while (std::getline(checksStream, check, ',')) {
+        if (check == "bbox-size") {
+            result.isBBoxSizeChecked = false;
+        } else if (check == "aspect-ratio") {
+            result.isAspectRatioChecked = false;
+        } else if (check == "fill-ratio") {
+            result.isFillRatioChecked = false;
+        } else if (check == "hu1") {
+            result.isHuInvariant1Checked = false;
+        } else {
+            Logger::error("Unknown check \"" + check + "\"");
+        }
+    }
+
+    return result;
+}
+
+const int
+Classifier::classify(const Features& features)
+const
+{
+    const size_t classesCount = this->classLetters.size();
+
+    std::array<std::array<float, maxClassesCount>, invariantsCount> distances;
+    // Squared Mahalanobis distances
+    std::array<float, maxClassesCount> squaredDistances;
+
+    squaredDistances.fill(0);
+
+    // Note: same operations for all classes, so the compiler handles a few per instruction
+    for (uint8_t no = 0; no < Classifier::invariantsCount; no++) {
+        const float value = features[no];
+        const float* means = this->means[no].data();
+
+        for (size_t classIdx = 0; classIdx < classesCount; classIdx++) {
+            distances[no][classIdx] = value - means[classIdx];
+        }
+    }
+
+    uint8_t entry = 0;
+
+    for (uint8_t row = 0; row < Classifier::invariantsCount; row++) {
+        std::array<float, maxClassesCount> whitenedDistances;
+
+        whitenedDistances.fill(0);
+
+        for (uint8_t no = 0; no <= row; no++, entry++) {
+            const float* whitenings = this->whitenings[entry].data();
+
+            for (size_t classIdx = 0; classIdx < classesCount; classIdx++) {
+                whitenedDistances[classIdx] += whitenings[classIdx] * distances[no][classIdx];
+            }
+        }
+
+        for (size_t classIdx = 0; classIdx < classesCount; classIdx++) {
+            squaredDistances[classIdx] += whitenedDistances[classIdx] * whitenedDistances[classIdx];
+        }
+    }
+
+    size_t nearestClassIdx = 0;
+
+    for (size_t classIdx = 1; classIdx < classesCount; classIdx++) {
+        if (squaredDistances[classIdx] < squaredDistances[nearestClassIdx]) {
+            nearestClassIdx = classIdx;
+        }
+    }
+
+    const double maxSquaredDistance = Classifier::invariantsCount * this->maxDistance * this->maxDistance;
+
+    if (squaredDistances[nearestClassIdx] > maxSquaredDistance) {
+        return -1;
+    }
+
+    return nearestClassIdx;
+}
+
+const size_t
+Classifier::getClassesCount()
+const
+{
+    return this->classLetters.size();
+}
+
+const char
+Classifier::getClassLetter(const size_t& classIdx)
+const
+{
+    return this->classLetters[classIdx];
+}
+
+const std::vector<size_t>&
+Classifier::getWord()
+const
+{
+    return this->word;
+}
+
+const std::pair<float, float>
+Classifier::getFeatureSpan(const uint8_t& no)
+const
+{
+    return this->spans[no - 1];
+}
+
+const Classifier::Prefilter&
+Classifier::getPrefilter()
+const
+{
+    return this->prefilter;
+}
+
+const void
+Classifier::setPrefilter(const Prefilter& prefilter)
+{
+    this->prefilter = prefilter;
+}
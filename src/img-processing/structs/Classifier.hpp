@@ -0,0 +1,125 @@
+#ifndef POBR_IMGPROCESSING_STRUCTS_CLASSIFIER_HPP
+#define POBR_IMGPROCESSING_STRUCTS_CLASSIFIER_HPP
+
+#include <cstdint>
+#include <array>
+#include <string>
+#include <vector>
+#include <utility>
+#include <istream>
+#include <ostream>
+
+namespace pobr::imgProcessing::structs
+{
+    // Letter classes of the word to detect, each described by the centroid of its features
+    // (log-scaled Hu invariants, see toFeatures) along with their covariances
+    // (see models/tesco.txt for the model file format).
+    // Centroids (and factors whitening features around them) are kept as tables
+    // with one row per value, holding values of all classes side by side,
+    // so a segment is compared with every class at once.
+    class Classifier
+    {
+    public:
+        static const uint8_t invariantsCount = 7;
+        static const size_t maxClassesCount = 64;
+
+        // -sign(hu) * log10(|hu|) of each Hu invariant, with invariants closer to 0 than double's
+        // epsilon (rounding errors, up to exactly 0) clamped to it, so they get the largest magnitude
+        // (positive for 0) instead of one between both signs' extremes
+        // Note: raw invariants span over ten orders of magnitude, these a few units
+        typedef std::array<float, invariantsCount> Features;
+
+        struct Centroid
+        {
+            Features means = {};
+            // Symmetric, positive-definite
+            std::array<Features, invariantsCount> covariances = {};
+        };
+
+        // Bounds of the cheaper checks segments go through before being classified
+        // (see Segment::FilterStage), loose enough to keep every letter, each check can be turned off
+        // Note: letters in "data/" are 9 - 56px per side, with aspect ratio up to 2.1
+        //       and 26% - 67% of their bounding box filled
+        struct Prefilter
+        {
+            bool isBBoxSizeChecked = true;
+            uint64_t minSide = 4;
+            uint64_t maxSide = 200;
+
+            bool isAspectRatioChecked = true;
+            double maxAspectRatio = 4;
+
+            bool isFillRatioChecked = true;
+            double minFillRatio = 0.15;
+            double maxFillRatio = 0.85;
+
+            // First feature within the span of all classes (see getFeatureSpan)
+            bool isHuInvariant1Checked = true;
+        };
+
+        static const Features toFeatures(const std::array<double, invariantsCount>& huInvariants);
+        static const float toFeature(const double& huInvariant);
+
+        // Note: errors (see Logger::error) on malformed models
+        static const Classifier fromFile(const std::string& path);
+        static const Classifier fromStream(std::istream& input, const std::string& sourceName);
+        // "word" is made of classes' letters, "maxDistance" as in classify()
+        static const Classifier fromCentroids(
+            const std::string& word,
+            const std::vector<char>& classLetters,
+            const std::vector<Centroid>& classCentroids,
+            const double& maxDistance,
+            const std::string& sourceName = "centroids"
+        );
+
+        // Model file's contents (see models/tesco.txt), read back as the same model
+        const void write(std::ostream& output) const;
+
+        // Model used by segments' classification, "TESCO" one (models/tesco.txt) unless replaced
+        // Note: not thread-safe, meant to be replaced once, at startup
+        static const Classifier& getModel();
+        static const void setModel(const Classifier& model);
+
+        // Same prefilter, without the checks listed in "checks" (comma separated,
+        // any of "bbox-size", "aspect-ratio", "fill-ratio" and "hu1")
+        // Note: errors (see Logger::error) on unknown checks
+        static const Prefilter skipChecks(const Prefilter& prefilter, const std::string& checks);
+
+        // Index of the class with the nearest centroid, "-1" if even that one is further away
+        // than the model's maximum distance (Mahalanobis distance, by class' covariances,
+        // divided by the square root of features count, so that it's in "deviations per feature")
+        // Note: the first of equally distant classes wins
+        const int classify(const Features& features) const;
+
+        const size_t getClassesCount() const;
+        const char getClassLetter(const size_t& classIdx) const;
+        // Letters of the word, as class indices, in reading order
+        const std::vector<size_t>& getWord() const;
+        // Values of a feature within the maximum distance of any class, "no" starts from 1
+        // Note: a segment with a feature outside of it is never classified
+        const std::pair<float, float> getFeatureSpan(const uint8_t& no) const;
+        // Note: not part of model files, every model starts with the default bounds
+        const Prefilter& getPrefilter() const;
+        const void setPrefilter(const Prefilter& prefilter);
+
+    protected:
+        // Entries of a lower triangular matrix, row by row
+        static const uint8_t whiteningsCount = (invariantsCount * (invariantsCount + 1)) / 2;
+
+        std::vector<char> classLetters;
+        std::vector<size_t> word;
+        double maxDistance = 0;
+        std::vector<Centroid> centroids;
+        Prefilter prefilter;
+
+        // Indexed as [feature][class]
+        std::array<std::vector<float>, invariantsCount> means;
+        // Indexed as [entry][class], inverse of covariances' Cholesky factor,
+        // turning features' distances into uncorrelated ones, in deviations
+        std::array<std::vector<float>, whiteningsCount> whitenings;
+        // Indexed as [feature]
+        std::array<std::pair<float, float>, invariantsCount> spans;
+    };
+}
+
+#endif
@@ -0,0 +1,310 @@
+#include "Moments.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+#include "../../utils/consts.hpp"
+
+namespace consts = pobr::utils::consts;
+
+using Moments = pobr::imgProcessing::structs::Moments;
+
+const Moments
+Moments::fromPixels(const cv::Mat_<uint8_t>& pixels)
+{
+    Moments moments;
+
+    for (int y = 0; y < pixels.rows; ++y) {
+        const auto row = pixels.ptr<uint8_t>(y);
+
+        uint64_t count = 0;
+        uint64_t sumX = 0;
+        uint64_t sumX2 = 0;
+        uint64_t sumX3 = 0;
+
+        for (uint64_t x = 0; x < pixels.cols; ++x) {
+            if (row[x] != consts::colors::white) {
+                continue;
+            }
+
+            count += 1;
+            sumX += x;
+            sumX2 += x * x;
+            sumX3 += x * x * x;
+        }
+
+        if (count == 0) {
+            continue;
+        }
+
+        moments.addRow(y, count, sumX, sumX2, sumX3);
+    }
+
+    return moments;
+}
+
+const Moments
+Moments::fromLabels(const cv::Mat_<int>& labels, const int& label)
+{
+    Moments moments;
+
+    for (int y = 0; y < labels.rows; ++y) {
+        const auto row = labels.ptr<int>(y);
+
+        uint64_t count = 0;
+        uint64_t sumX = 0;
+        uint64_t sumX2 = 0;
+        uint64_t sumX3 = 0;
+
+        for (uint64_t x = 0; x < labels.cols; ++x) {
+            if (row[x] != label) {
+                continue;
+            }
+
+            count += 1;
+            sumX += x;
+            sumX2 += x * x;
+            sumX3 += x * x * x;
+        }
+
+        if (count == 0) {
+            continue;
+        }
+
+        moments.addRow(y, count, sumX, sumX2, sumX3);
+    }
+
+    return moments;
+}
+
+const void
+Moments::addRow(
+    const uint64_t& y,
+    const uint64_t& count,
+    const uint64_t& sumX,
+    const uint64_t& sumX2,
+    const uint64_t& sumX3
+)
+{
+    const uint64_t y2 = y * y;
+    const uint64_t y3 = y2 * y;
+
+    this->raw[0][0] += count;
+    this->raw[0][1] += sumX;
+    this->raw[0][2] += sumX2;
+    this->raw[0][3] += sumX3;
+
+    this->raw[1][0] += y * count;
+    this->raw[1][1] += y * sumX;
+    this->raw[1][2] += y * sumX2;
+
+    this->raw[2][0] += y2 * count;
+    this->raw[2][1] += y2 * sumX;
+
+    this->raw[3][0] += y3 * count;
+}
+
+const void
+Moments::addPixel(const uint64_t& y, const uint64_t& x)
+{
+    this->addRow(y, 1, x, x * x, x * x * x);
+}
+
+const void
+Moments::merge(const Moments& other)
+{
+    for (uint8_t p = 0; p <= maxOrder; ++p) {
+        for (uint8_t q = 0; p + q <= maxOrder; ++q) {
+            this->raw[p][q] += other.raw[p][q];
+        }
+    }
+}
+
+const Moments
+Moments::getTranslated(const uint64_t& originY, const uint64_t& originX)
+const
+{
+    // Binomial coefficients, up to maxOrder
+    const uint64_t binomial[maxOrder + 1][maxOrder + 1] = {
+        { 1, 0, 0, 0 },
+        { 1, 1, 0, 0 },
+        { 1, 2, 1, 0 },
+        { 1, 3, 3, 1 }
+    };
+
+    // Powers of the negated origin, wrapping around on purpose
+    std::array<uint64_t, maxOrder + 1> powersY = { 1 };
+    std::array<uint64_t, maxOrder + 1> powersX = { 1 };
+
+    for (uint8_t i = 1; i <= maxOrder; ++i) {
+        powersY[i] = powersY[i - 1] * (0 - originY);
+        powersX[i] = powersX[i - 1] * (0 - originX);
+    }
+
+    Moments translated;
+
+    for (uint8_t p = 0; p <= maxOrder; ++p) {
+        for (uint8_t q = 0; p + q <= maxOrder; ++q) {
+            uint64_t value = 0;
+
+            // sum((y - originY)^p * (x - originX)^q)
+            for (uint8_t i = 0; i <= p; ++i) {
+                for (uint8_t j = 0; j <= q; ++j) {
+                    value += (
+                        binomial[p][i] * binomial[q][j] *
+                        powersY[p - i] * powersX[q - j] *
+                        this->raw[i][j]
+                    );
+                }
+            }
+
+            translated.raw[p][q] = value;
+        }
+    }
+
+    return translated;
+}
+
+const bool
+Moments::isExact(const uint64_t& width, const uint64_t& height)
+const
+{
+    // Largest coordinate within the box
+    const double maxCoordinate = std::max<double>(std::max(width, height), 1) - 1;
+
+    // Note: compared with some margin below 2^64, as the bound itself is rounded
+    return (this->getArea() * std::pow(maxCoordinate, maxOrder)) < std::ldexp(1.0, 63);
+}
+
+const uint64_t
+Moments::getArea()
+const
+{
+    return this->raw[0][0];
+}
+
+const double
+Moments::getRaw(const uint8_t& p, const uint8_t& q)
+const
+{
+    if (p + q > Moments::maxOrder) {
+        return 0;
+    }
+
+    return this->raw[p][q];
+}
+
+const double
+Moments::getCentral(const uint8_t& p, const uint8_t& q)
+const
+{
+    const double m00 = this->getRaw(0, 0);
+    const double m10 = this->getRaw(1, 0);
+    const double m01 = this->getRaw(0, 1);
+
+    const auto xTilde = (m01 / m00);
+    const auto yTilde = (m10 / m00);
+
+    // Binomial expansion of sum((y - yTilde)^p * (x - xTilde)^q),
+    // simplified with m10 = yTilde * m00 and m01 = xTilde * m00
+    switch ((p * 10) + q) {
+    case 0:
+        return m00;
+    case 1:
+    case 10:
+        return 0;
+    case 2:
+        return this->getRaw(0, 2) - (xTilde * m01);
+    case 20:
+        return this->getRaw(2, 0) - (yTilde * m10);
+    case 11:
+        return this->getRaw(1, 1) - (xTilde * m10);
+    case 3:
+        return (
+            this->getRaw(0, 3) -
+            (3 * xTilde * this->getRaw(0, 2)) +
+            (2 * xTilde * xTilde * m01)
+        );
+    case 30:
+        return (
+            this->getRaw(3, 0) -
+            (3 * yTilde * this->getRaw(2, 0)) +
+            (2 * yTilde * yTilde * m10)
+        );
+    case 21:
+        return (
+            this->getRaw(2, 1) -
+            (xTilde * this->getRaw(2, 0)) -
+            (2 * yTilde * this->getRaw(1, 1)) +
+            (2 * yTilde * yTilde * m01)
+        );
+    case 12:
+        return (
+            this->getRaw(1, 2) -
+            (yTilde * this->getRaw(0, 2)) -
+            (2 * xTilde * this->getRaw(1, 1)) +
+            (2 * xTilde * xTilde * m10)
+        );
+    }
+
+    return 0;
+}
+
+const std::array<double, 7>
+Moments::getHuInvariants()
+const
+{
+    const double m00 = this->getRaw(0, 0);
+
+    const auto mu20 = this->getCentral(2, 0);
+    const auto mu02 = this->getCentral(0, 2);
+    const auto mu11 = this->getCentral(1, 1);
+    const auto mu30 = this->getCentral(3, 0);
+    const auto mu03 = this->getCentral(0, 3);
+    const auto mu21 = this->getCentral(2, 1);
+    const auto mu12 = this->getCentral(1, 2);
+
+    const auto sum3012 = mu30 + mu12;
+    const auto sum2103 = mu21 + mu03;
+    const auto diff3012 = mu30 - (3 * mu12);
+    const auto diff2103 = (3 * mu21) - mu03;
+
+    std::array<double, 7> invariants;
+
+    invariants[0] = this->getHuInvariant1();
+    invariants[1] = (
+        std::pow(mu20 - mu02, 2) +
+        (4 * std::pow(mu11, 2))
+    ) / std::pow(m00, 4);
+    invariants[2] = (
+        std::pow(diff3012, 2) +
+        std::pow(diff2103, 2)
+    ) / std::pow(m00, 5);
+    // Note: (mu21 - mu03) instead of the textbook (mu21 + mu03),
+    //       kept as-is since the classifier model was trained with it
+    invariants[3] = (
+        std::pow(sum3012, 2) +
+        std::pow(mu21 - mu03, 2)
+    ) / std::pow(m00, 5);
+    invariants[4] = (
+        (diff3012 * sum3012 * (std::pow(sum3012, 2) - (3 * std::pow(sum2103, 2)))) +
+        (diff2103 * sum2103 * ((3 * std::pow(sum3012, 2)) - std::pow(sum2103, 2)))
+    ) / std::pow(m00, 10);
+    invariants[5] = (
+        ((mu20 - mu02) * (std::pow(sum3012, 2) - std::pow(sum2103, 2))) +
+        (4 * mu11 * sum3012 * sum2103)
+    ) / std::pow(m00, 7);
+    invariants[6] = (
+        (mu20 * mu02) -
+        std::pow(mu11, 2)
+    ) / std::pow(m00, 4);
+
+    return invariants;
+}
+
+const double
+Moments::getHuInvariant1()
+const
+{
+    return (this->getCentral(2, 0) + this->getCentral(0, 2)) / std::pow(this->getRaw(0, 0), 2);
+}
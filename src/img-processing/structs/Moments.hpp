@@ -0,0 +1,58 @@
+#ifndef POBR_IMGPROCESSING_STRUCTS_MOMENTS_HPP
+#define POBR_IMGPROCESSING_STRUCTS_MOMENTS_HPP
+
+#include <cstdint>
+#include <array>
+#include <opencv2/core/core.hpp>
+
+namespace pobr::imgProcessing::structs
+{
+    // Raw geometric moments of a binary shape, up to order 3.
+    // Follows Segment's convention: m(p, q) = sum(y^p * x^q),
+    // so "p" is the power of the row and "q" the power of the column.
+    struct Moments
+    {
+    public:
+        static const uint8_t maxOrder = 3;
+
+        static const Moments fromPixels(const cv::Mat_<uint8_t>& pixels);
+        // Shape made of pixels equal to "label"
+        static const Moments fromLabels(const cv::Mat_<int>& labels, const int& label);
+
+        const void addRow(
+            const uint64_t& y,
+            const uint64_t& count,
+            const uint64_t& sumX,
+            const uint64_t& sumX2,
+            const uint64_t& sumX3
+        );
+        // Single pixel, for shapes not visited row by row (eg. flood fill)
+        const void addPixel(const uint64_t& y, const uint64_t& x);
+
+        // Adds moments of another shape (measured from the same origin)
+        const void merge(const Moments& other);
+
+        // Moments of the same shape, measured from (originY, originX) instead of (0, 0)
+        // Note: computed modulo 2^64, so the result is exact whenever it fits,
+        //       even if the moments being shifted have already overflowed
+        const Moments getTranslated(const uint64_t& originY, const uint64_t& originX) const;
+
+        // Whether these (local) moments are guaranteed to fit in 64 bits, and so to be exact,
+        // for a shape within a box of given size, measured from its top-left corner
+        // Note: true for anything the size of a letter, as moments are at most area * maxSide^3
+        const bool isExact(const uint64_t& width, const uint64_t& height) const;
+
+        const uint64_t getArea() const;
+        const double getRaw(const uint8_t& p, const uint8_t& q) const;
+        const double getCentral(const uint8_t& p, const uint8_t& q) const;
+        const std::array<double, 7> getHuInvariants() const;
+        // First of the above alone, much cheaper than all of them
+        const double getHuInvariant1() const;
+
+    protected:
+        // Indexed as [p][q], only entries with p + q <= maxOrder are used
+        std::array<std::array<uint64_t, maxOrder + 1>, maxOrder + 1> raw = {};
+    };
+}
+
+#endif
@@ -0,0 +1,48 @@
+#include "ScratchArena.hpp"
+
+#include <algorithm>
+
+using ScratchArena = pobr::imgProcessing::structs::ScratchArena;
+
+cv::Mat
+ScratchArena::getImg(const size_t& slot, const int& rows, const int& cols, const int& type)
+{
+    if (slot >= this->slots.size()) {
+        this->slots.resize(slot + 1);
+    }
+
+    auto& storage = this->slots[slot];
+
+    if (storage.empty() || storage.type() != type) {
+        storage.create(rows, cols, type);
+    } else if (storage.rows < rows || storage.cols < cols) {
+        // Note: grows in both dimensions at once, so images of alternating orientation
+        //       settle on a single allocation
+        storage.create(
+            std::max(storage.rows, rows),
+            std::max(storage.cols, cols),
+            type
+        );
+    }
+
+    return storage(cv::Rect(0, 0, cols, rows));
+}
+
+const uint64_t
+ScratchArena::getReservedBytes()
+const
+{
+    uint64_t bytes = 0;
+
+    for (const auto& storage: this->slots) {
+        bytes += storage.total() * storage.elemSize();
+    }
+
+    return bytes;
+}
+
+const void
+ScratchArena::release()
+{
+    this->slots.clear();
+}
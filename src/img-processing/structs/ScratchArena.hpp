@@ -0,0 +1,33 @@
+#ifndef POBR_IMGPROCESSING_STRUCTS_SCRATCHARENA_HPP
+#define POBR_IMGPROCESSING_STRUCTS_SCRATCHARENA_HPP
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+namespace pobr::imgProcessing::structs
+{
+    // Image buffers reused between pipeline runs, each in its own numbered slot.
+    // A slot grows up to the largest image requested from it so far (its high-water mark)
+    // and hands out views of its top-left corner, so same-sized or smaller images
+    // need no allocation at all.
+    // Note: views share slot's memory (and reference count), so the ones handed out
+    //       before a slot had to grow stay valid, they just stop being reused
+    // Note: not thread-safe, use one per thread
+    class ScratchArena
+    {
+    public:
+        // View of "slot" memory, of given size and type (see cv::Mat::type)
+        // Note: contents are left as they are, and views of the same slot overlap
+        cv::Mat getImg(const size_t& slot, const int& rows, const int& cols, const int& type);
+
+        // Memory held by all slots (the sum of their high-water marks)
+        const uint64_t getReservedBytes() const;
+        const void release();
+
+    protected:
+        std::vector<cv::Mat> slots;
+    };
+}
+
+#endif
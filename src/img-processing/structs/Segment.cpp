@@ -1,8 +1,51 @@
 #include "Segment.hpp"
 
 #include <cmath>
+#include <algorithm>
 
 using Segment = pobr::imgProcessing::structs::Segment;
+using Moments = pobr::imgProcessing::structs::Moments;
+using Classifier = pobr::imgProcessing::structs::Classifier;
+
+const std::string
+Segment::getClassificationName(const Classification& classification)
+{
+    switch (classification) {
+    case Classification::ErrorTooSmall:
+        return "ERROR_TOOSMALL";
+    case Classification::ErrorTooBig:
+        return "ERROR_TOOBIG";
+    case Classification::ErrorUnknown:
+        return "ERROR_UNKNOWN";
+    case Classification::Letter:
+        return "LETTER";
+    }
+
+    return "ERROR_UNKNOWN";
+}
+
+const std::string
+Segment::getFilterStageName(const FilterStage& filterStage)
+{
+    switch (filterStage) {
+    case FilterStage::Area:
+        return "area";
+    case FilterStage::BBoxSize:
+        return "bbox size";
+    case FilterStage::AspectRatio:
+        return "aspect ratio";
+    case FilterStage::FillRatio:
+        return "fill ratio";
+    case FilterStage::HuInvariant1:
+        return "hu1";
+    case FilterStage::HuInvariants:
+        return "hu1-7";
+    case FilterStage::Passed:
+        return "passed";
+    }
+
+    return "passed";
+}
 
 const double
 Segment::getDistance(const Segment& left, const Segment& right)
@@ -33,27 +76,97 @@ Segment::updateBoundaries(const uint64_t& x, const uint64_t& y)
 }
 
 const void
-Segment::updatePixels(const cv::Mat_<cv::Vec3i>& segmentedImg, const int& segmentID)
+Segment::updatePixels(const cv::Mat_<int>& segmentedImg, const int& segmentID)
+{
+    this->updateLabelsView(segmentedImg, segmentID);
+    this->updateFeatures(Moments::fromLabels(this->labelsView, segmentID));
+}
+
+const void
+Segment::updatePixels(const cv::Mat_<int>& segmentedImg, const int& segmentID, const Moments& moments)
+{
+    this->updateLabelsView(segmentedImg, segmentID);
+    this->updateFeatures(moments);
+}
+
+const void
+Segment::updateMoments(const Moments& moments)
+{
+    this->updateFeatures(moments);
+}
+
+const void
+Segment::updateLabelsView(const cv::Mat_<int>& segmentedImg, const int& segmentID)
 {
-    this->pixels = cv::Mat_<cv::Vec3b>(
-        (this->yMax - this->yMin + 1),
-        (this->xMax - this->xMin + 1)
+    this->label = segmentID;
+    this->labelsView = segmentedImg(
+        cv::Rect(
+            this->xMin,
+            this->yMin,
+            this->getWidth(),
+            this->getHeight()
+        )
     );
+}
+
+const cv::Mat_<int>&
+Segment::getLabelsView()
+const
+{
+    return this->labelsView;
+}
 
-    for (int x = 0; x < (this->xMax - this->xMin + 1); x++) {
-        for (int y = 0; y < (this->yMax - this->yMin + 1); y++) {
-            auto& thisSegmentID = segmentedImg(this->yMin + y, this->xMin + x)[0];
+const void
+Segment::detachLabelsView()
+{
+    this->labelsView = this->labelsView.clone();
+}
+
+const cv::Mat_<uint8_t>
+Segment::getPixels()
+const
+{
+    cv::Mat_<uint8_t> pixels(this->labelsView.rows, this->labelsView.cols);
 
-            this->pixels(y, x)[1] = consts::colors::black;
-            this->pixels(y, x)[2] = consts::colors::black;
+    for (int y = 0; y < pixels.rows; y++) {
+        const auto labelsRow = this->labelsView.ptr<int>(y);
+        auto pixelsRow = pixels.ptr<uint8_t>(y);
 
-            if (thisSegmentID != segmentID) {
-                this->pixels(y, x)[0] = consts::colors::black;
+        for (int x = 0; x < pixels.cols; x++) {
+            if (labelsRow[x] != this->label) {
+                pixelsRow[x] = consts::colors::black;
             } else {
-                this->pixels(y, x)[0] = consts::colors::white;
+                pixelsRow[x] = consts::colors::white;
             }
         }
     }
+
+    return pixels;
+}
+
+const void
+Segment::updateFeatures(const Moments& moments)
+{
+    this->features.area = moments.getArea();
+    this->features.moments = moments;
+    this->features.huInvariants = {};
+    this->features.huFeatures = {};
+    this->filterStage = this->computeFilterStage();
+    this->classIdx = -1;
+
+    // Note: all invariants are only needed by segments left for the classifier
+    if (this->filterStage == FilterStage::HuInvariants) {
+        this->features.huInvariants = this->computeHuInvariants();
+        this->features.huFeatures = Classifier::toFeatures(this->features.huInvariants);
+        this->classIdx = Classifier::getModel().classify(this->features.huFeatures);
+    }
+
+    // Features never change afterwards, so neither does the classification
+    this->classification = this->computeClassification();
+
+    if (this->isClassifiedAsLetter()) {
+        this->filterStage = FilterStage::Passed;
+    }
 }
 
 const void
@@ -63,6 +176,15 @@ Segment::merge(const Segment& other)
     this->updateBoundaries(other.xMax, other.yMax);
 }
 
+const void
+Segment::translate(const uint64_t& x, const uint64_t& y)
+{
+    this->xMin += x;
+    this->xMax += x;
+    this->yMin += y;
+    this->yMax += y;
+}
+
 const bool
 Segment::isValid()
 const
@@ -118,34 +240,24 @@ const uint64_t
 Segment::getArea()
 const
 {
-    uint64_t area = 0;
-
-    for (int x = 0; x < this->pixels.cols; ++x) {
-        for (int y = 0; y < this->pixels.rows; ++y) {
-            auto& point = this->pixels(y, x);
-
-            if (point[0] != consts::colors::white) {
-                continue;
-            }
-
-            area++;
-        }
-    }
-
-    return area;
+    return this->features.area;
 }
 
 const double
 Segment::getNormalMoment(const uint64_t& p, const uint64_t& q)
 const
 {
+    if (this->hasExactMoment(p, q)) {
+        return this->features.moments.getRaw(p, q);
+    }
+
     double value = 0;
 
-    for (int x = 0; x < this->pixels.cols; ++x) {
-        for (int y = 0; y < this->pixels.rows; ++y) {
-            auto& point = this->pixels.at<cv::Vec3b>(y, x);
+    for (int y = 0; y < this->labelsView.rows; ++y) {
+        const auto row = this->labelsView.ptr<int>(y);
 
-            if (point[0] != consts::colors::white) {
+        for (int x = 0; x < this->labelsView.cols; ++x) {
+            if (row[x] != this->label) {
                 continue;
             }
 
@@ -165,11 +277,33 @@ const
     const auto xTilde = (m01 / m00);
     const auto yTilde = (m10 / m00);
 
-    for (int x = 0; x < this->pixels.cols; ++x) {
-        for (int y = 0; y < this->pixels.rows; ++y) {
-            auto& point = this->pixels.at<cv::Vec3b>(y, x);
+    if (this->hasExactMoment(p, q)) {
+        // Binomial expansion of sum((y - yTilde)^p * (x - xTilde)^q) over raw moments
+        const double binomial[Moments::maxOrder + 1][Moments::maxOrder + 1] = {
+            { 1, 0, 0, 0 },
+            { 1, 1, 0, 0 },
+            { 1, 2, 1, 0 },
+            { 1, 3, 3, 1 }
+        };
+
+        for (uint64_t i = 0; i <= p; ++i) {
+            for (uint64_t j = 0; j <= q; ++j) {
+                value += (
+                    binomial[p][i] * binomial[q][j] *
+                    std::pow(-yTilde, p - i) * std::pow(-xTilde, q - j) *
+                    this->features.moments.getRaw(i, j)
+                );
+            }
+        }
+
+        return value;
+    }
 
-            if (point[0] != consts::colors::white) {
+    for (int y = 0; y < this->labelsView.rows; ++y) {
+        const auto row = this->labelsView.ptr<int>(y);
+
+        for (int x = 0; x < this->labelsView.cols; ++x) {
+            if (row[x] != this->label) {
                 continue;
             }
 
@@ -180,542 +314,158 @@ const
     return value;
 }
 
-const double
-Segment::getHuMomentInvariant(const uint8_t& no)
+const bool
+Segment::hasExactMoment(const uint64_t& p, const uint64_t& q)
 const
 {
-    switch (no) {
-    case 1:
-        return this->getHuMomentInvariantNo1();
-    case 2:
-        return this->getHuMomentInvariantNo2();
-    case 3:
-        return this->getHuMomentInvariantNo3();
-    case 4:
-        return this->getHuMomentInvariantNo4();
-    case 5:
-        return this->getHuMomentInvariantNo5();
-    case 6:
-        return this->getHuMomentInvariantNo6();
-    case 7:
-        return this->getHuMomentInvariantNo7();
-    }
-
-    return -1;
+    return (
+        p + q <= Moments::maxOrder &&
+        this->features.moments.isExact(this->getWidth(), this->getHeight())
+    );
 }
 
-const std::string
-Segment::classify()
+const double
+Segment::getHuMomentInvariant(const uint8_t& no)
 const
 {
-    if (!this->isBigEnough()) {
-        return "ERROR_TOOSMALL";
-    }
-    if (!this->isSmallEnough()) {
-        return "ERROR_TOOBIG";
-    }
-
-    if (this->isLetterT()) {
-        return "LETTER_T";
-    }
-    if (this->isLetterO()) {
-        return "LETTER_O";
-    }
-    if (this->isLetterS()) {
-        return "LETTER_S";
-    }
-    if (this->isLetterE()) {
-        return "LETTER_E";
-    }
-    if (this->isLetterC()) {
-        return "LETTER_C";
+    if (no < 1 || no > this->features.huInvariants.size()) {
+        return -1;
     }
 
-    return "ERROR_UNKNOWN";
+    return this->features.huInvariants[no - 1];
 }
 
-const bool
-Segment::isSmallEnough()
+const std::array<double, 7>
+Segment::computeHuInvariants()
 const
 {
-    return (this->getArea() <= 3000);
-}
+    const auto& moments = this->features.moments;
 
-const bool
-Segment::isBigEnough()
-const
-{
-    return (this->getArea() >= 60);
-}
+    if (!moments.isExact(this->getWidth(), this->getHeight())) {
+        return {};
+    }
 
-const bool
-Segment::isClassifiedAsLetter()
-const
-{
-    return this->classify().find("LETTER_") != std::string::npos;
+    return moments.getHuInvariants();
 }
 
-const double
-Segment::getHuMomentInvariantNo1()
+const Segment::Features&
+Segment::getFeatures()
 const
 {
-    const auto m00 = this->getNormalMoment(0, 0);
-    const auto m01 = this->getNormalMoment(0, 1);
-    const auto m10 = this->getNormalMoment(1, 0);
-
-    return (
-        (
-            getCentralMoment(2, 0, m00, m10, m01) +
-            getCentralMoment(0, 2, m00, m10, m01)
-        )
-        /
-        std::pow(m00, 2)
-    );
+    return this->features;
 }
 
-const double
-Segment::getHuMomentInvariantNo2()
+const Segment::Classification
+Segment::classify()
 const
 {
-    const auto m00 = this->getNormalMoment(0, 0);
-    const auto m01 = this->getNormalMoment(0, 1);
-    const auto m10 = this->getNormalMoment(1, 0);
-
-    return (
-        (
-            std::pow(
-                (
-                    getCentralMoment(2, 0, m00, m10, m01) -
-                    getCentralMoment(0, 2, m00, m10, m01)
-                ),
-                2
-            )
-            +
-            (
-                4 *
-                std::pow(
-                    getCentralMoment(1, 1, m00, m10, m01),
-                    2
-                )
-            )
-        )
-        /
-        std::pow(m00, 4)
-    );
+    return this->classification;
 }
 
-const double
-Segment::getHuMomentInvariantNo3()
+const int
+Segment::getClassIdx()
 const
 {
-    const auto m00 = this->getNormalMoment(0, 0);
-    const auto m01 = this->getNormalMoment(0, 1);
-    const auto m10 = this->getNormalMoment(1, 0);
-
-    return (
-        (
-            std::pow(
-                (
-                    (1 * this->getCentralMoment(3, 0, m00, m10, m01)) -
-                    (3 * this->getCentralMoment(1, 2, m00, m10, m01))
-                ),
-                2
-            )
-            +
-            std::pow(
-                (
-                    (3 * this->getCentralMoment(2, 1, m00, m10, m01)) -
-                    (1 * this->getCentralMoment(0, 3, m00, m10, m01))
-                ),
-                2
-            )
-        )
-        /
-        std::pow(m00, 5)
-    );
+    return this->classIdx;
 }
 
-const double
-Segment::getHuMomentInvariantNo4()
+const Segment::FilterStage
+Segment::getFilterStage()
 const
 {
-    const auto m00 = this->getNormalMoment(0, 0);
-    const auto m01 = this->getNormalMoment(0, 1);
-    const auto m10 = this->getNormalMoment(1, 0);
-
-    return (
-        (
-            std::pow(
-                (
-                    this->getCentralMoment(3, 0, m00, m10, m01) +
-                    this->getCentralMoment(1, 2, m00, m10, m01)
-                ),
-                2
-            )
-            +
-            std::pow(
-                (
-                    this->getCentralMoment(2, 1, m00, m10, m01) -
-                    this->getCentralMoment(0, 3, m00, m10, m01)
-                ),
-                2
-            )
-        )
-        /
-        std::pow(m00, 5)
-    );
+    return this->filterStage;
 }
 
-const double
-Segment::getHuMomentInvariantNo5()
+const Segment::FilterStage
+Segment::computeFilterStage()
 const
 {
-    const auto m00 = this->getNormalMoment(0, 0);
-    const auto m01 = this->getNormalMoment(0, 1);
-    const auto m10 = this->getNormalMoment(1, 0);
+    if (!this->isBigEnough() || !this->isSmallEnough()) {
+        return FilterStage::Area;
+    }
 
-    return (
-        (
-            (
-                (
-                    (1 * this->getCentralMoment(3, 0, m00, m10, m01)) -
-                    (3 * this->getCentralMoment(1, 2, m00, m10, m01))
-                )
-                *
-                (
-                    this->getCentralMoment(3, 0, m00, m10, m01) +
-                    this->getCentralMoment(1, 2, m00, m10, m01)
-                )
-                *
-                (
-                    (
-                        1 *
-                        std::pow(
-                            (
-                                this->getCentralMoment(3, 0, m00, m10, m01) +
-                                this->getCentralMoment(1, 2, m00, m10, m01)
-                            ),
-                            2
-                        )
-                    )
-                    -
-                    (
-                        3 *
-                        std::pow(
-                            (
-                                this->getCentralMoment(2, 1, m00, m10, m01) +
-                                this->getCentralMoment(0, 3, m00, m10, m01)
-                            ),
-                            2
-                        )
-                    )
-                )
-            )
-            +
-            (
-                (
-                    (3 * this->getCentralMoment(2, 1, m00, m10, m01)) -
-                    (1 * this->getCentralMoment(0, 3, m00, m10, m01))
-                )
-                *
-                (
-                    this->getCentralMoment(2, 1, m00, m10, m01) +
-                    this->getCentralMoment(0, 3, m00, m10, m01)
-                )
-                *
-                (
-                    (
-                        3 *
-                        std::pow(
-                            (
-                                this->getCentralMoment(3, 0, m00, m10, m01) +
-                                this->getCentralMoment(1, 2, m00, m10, m01)
-                            ),
-                            2
-                        )
-                    )
-                    -
-                    (
-                        1 *
-                        std::pow(
-                            (
-                                this->getCentralMoment(2, 1, m00, m10, m01) +
-                                this->getCentralMoment(0, 3, m00, m10, m01)
-                            ),
-                            2
-                        )
-                    )
-                )
-            )
-        )
-        /
-        std::pow(m00, 10)
-    );
-}
+    const auto& prefilter = Classifier::getModel().getPrefilter();
 
-const double
-Segment::getHuMomentInvariantNo6()
-const
-{
-    const auto m00 = this->getNormalMoment(0, 0);
-    const auto m01 = this->getNormalMoment(0, 1);
-    const auto m10 = this->getNormalMoment(1, 0);
+    const auto width = this->getWidth();
+    const auto height = this->getHeight();
 
-    return (
-        (
-            (
-                (
-                    this->getCentralMoment(2, 0, m00, m10, m01) -
-                    this->getCentralMoment(0, 2, m00, m10, m01)
-                )
-                *
-                (
-                    std::pow(
-                        (
-                            this->getCentralMoment(3, 0, m00, m10, m01) +
-                            this->getCentralMoment(1, 2, m00, m10, m01)
-                        ),
-                        2
-                    )
-                    -
-                    std::pow(
-                        (
-                            this->getCentralMoment(2, 1, m00, m10, m01) +
-                            this->getCentralMoment(0, 3, m00, m10, m01)
-                        ),
-                        2
-                    )
-                )
-            )
-            +
-            (
-                (
-                    4 *
-                    this->getCentralMoment(1, 1, m00, m10, m01)
-                )
-                *
-                (
-                    this->getCentralMoment(3, 0, m00, m10, m01) +
-                    this->getCentralMoment(1, 2, m00, m10, m01)
-                )
-                *
-                (
-                    this->getCentralMoment(2, 1, m00, m10, m01) +
-                    this->getCentralMoment(0, 3, m00, m10, m01)
-                )
-            )
+    if (
+        prefilter.isBBoxSizeChecked && (
+            std::min(width, height) < prefilter.minSide ||
+            std::max(width, height) > prefilter.maxSide
         )
-        /
-        std::pow(m00, 7)
-    );
-}
+    ) {
+        return FilterStage::BBoxSize;
+    }
 
-const double
-Segment::getHuMomentInvariantNo7()
-const
-{
-    const auto m00 = this->getNormalMoment(0, 0);
-    const auto m01 = this->getNormalMoment(0, 1);
-    const auto m10 = this->getNormalMoment(1, 0);
+    if (prefilter.isAspectRatioChecked) {
+        const double aspectRatio = ((double) std::max(width, height)) / std::min(width, height);
 
-    return (
-        (
-            (
-                this->getCentralMoment(2, 0, m00, m10, m01) *
-                this->getCentralMoment(0, 2, m00, m10, m01)
-            )
-            -
-            std::pow(
-                this->getCentralMoment(1, 1, m00, m10, m01),
-                2
-            )
-        )
-        /
-        std::pow(m00, 4)
-    );
-}
+        if (aspectRatio > prefilter.maxAspectRatio) {
+            return FilterStage::AspectRatio;
+        }
+    }
 
-const bool
-Segment::isLetterT()
-const
-{
-    const auto hu1 = this->getHuMomentInvariant(1);
-    const auto hu2 = this->getHuMomentInvariant(2);
-    const auto hu3 = this->getHuMomentInvariant(3);
-    const auto hu4 = this->getHuMomentInvariant(4);
-    const auto hu5 = this->getHuMomentInvariant(5);
-    const auto hu6 = this->getHuMomentInvariant(6);
-    const auto hu7 = this->getHuMomentInvariant(7);
+    if (prefilter.isFillRatioChecked) {
+        const double fillRatio = ((double) this->getArea()) / this->getBBoxArea();
 
-    if (hu1 < 0.307891 * 0.95 || hu1 > 0.594335 * 1.05) {
-        return false;
-    }
-    if (hu2 < 0.001351 * 0.95 || hu2 > 0.169166 * 1.05) {
-        return false;
-    }
-    if (hu3 < 0.015959 * 1 || hu3 > 0.202738 * 1.05) {
-        return false;
-    }
-    if (hu4 < 0.000067 * 0.95 || hu4 > 0.049295 * 1.05) {
-        return false;
-    }
-    if (hu5 < -0.000001 || hu5 > 0.004918 * 1.05) {
-        return false;
+        if (fillRatio < prefilter.minFillRatio || fillRatio > prefilter.maxFillRatio) {
+            return FilterStage::FillRatio;
+        }
     }
-    if (hu6 < -0.000001 || hu6 > 0.017944 * 1.05) {
-        return false;
+
+    // Note: invariants are unknown without exact moments (see Moments::isExact),
+    //       which only happens for boxes far bigger than a letter, even with bbox size unchecked
+    if (!this->features.moments.isExact(width, height)) {
+        return FilterStage::HuInvariant1;
     }
-    if (hu7 < 0.02213 * 0.95 || hu7 > 0.061017 * 1.05) {
-        return false;
+
+    if (prefilter.isHuInvariant1Checked) {
+        const float hu1 = Classifier::toFeature(this->features.moments.getHuInvariant1());
+        const auto hu1Span = Classifier::getModel().getFeatureSpan(1);
+
+        if (hu1 < hu1Span.first || hu1 > hu1Span.second) {
+            return FilterStage::HuInvariant1;
+        }
     }
 
-    return true;
+    return FilterStage::HuInvariants;
 }
 
-const bool
-Segment::isLetterE()
+const Segment::Classification
+Segment::computeClassification()
 const
 {
-    const auto hu1 = this->getHuMomentInvariant(1);
-    const auto hu2 = this->getHuMomentInvariant(2);
-    const auto hu3 = this->getHuMomentInvariant(3);
-    const auto hu4 = this->getHuMomentInvariant(4);
-    const auto hu5 = this->getHuMomentInvariant(5);
-    const auto hu6 = this->getHuMomentInvariant(6);
-    const auto hu7 = this->getHuMomentInvariant(7);
-
-    if (hu1 < 0.266877 * 0.95 || hu1 > 0.580719 * 1.05) {
-        return false;
-    }
-    if (hu2 < 0.003589 * 0.95 || hu2 > 0.170131 * 1.05) {
-        return false;
-    }
-    if (hu3 < 0.000315 * 0.95 || hu3 > 0.015959 * 1) {
-        return false;
-    }
-    if (hu4 < 0.000005 * 0.95 || hu4 > 0.004738 * 1.05) {
-        return false;
-    }
-    if (hu5 < -0.000012 * 1.05 || hu5 > 0.000029 * 1.05) {
-        return false;
+    if (!this->isBigEnough()) {
+        return Classification::ErrorTooSmall;
     }
-    if (hu6 < -0.000882 * 1.05 || hu6 > 0.000715 * 1.05) {
-        return false;
+    if (!this->isSmallEnough()) {
+        return Classification::ErrorTooBig;
     }
-    if (hu7 < 0.016909 * 0.95 || hu7 > 0.041776 * 1.05) {
-        return false;
+    if (this->classIdx < 0) {
+        return Classification::ErrorUnknown;
     }
 
-    return true;
+    return Classification::Letter;
 }
 
 const bool
-Segment::isLetterS()
+Segment::isSmallEnough()
 const
 {
-    const auto hu1 = this->getHuMomentInvariant(1);
-    const auto hu2 = this->getHuMomentInvariant(2);
-    const auto hu3 = this->getHuMomentInvariant(3);
-    const auto hu4 = this->getHuMomentInvariant(4);
-    const auto hu5 = this->getHuMomentInvariant(5);
-    const auto hu6 = this->getHuMomentInvariant(6);
-    const auto hu7 = this->getHuMomentInvariant(7);
-
-    if (hu1 < 0.278918 * 0.95 || hu1 > 0.463963 * 1.05) {
-        return false;
-    }
-    if (hu2 < 0.000547 * 0.95 || hu2 > 0.074239 * 1.05) {
-        return false;
-    }
-    if (hu3 < 0.000022 * 0.95 || hu3 > 0.000878 * 1.05) {
-        return false;
-    }
-    if (hu4 < -0.000001 || hu4 > 0.000143 * 1.05) {
-        return false;
-    }
-    if (hu5 < -0.000001 || hu5 > 0.000001) {
-        return false;
-    }
-    if (hu6 < -0.000018 * 1.05 || hu6 > 0.000034 * 1.05) {
-        return false;
-    }
-    if (hu7 < 0.018778 * 0.95 || hu7 > 0.037327 * 1.05) {
-        return false;
-    }
-
-    return true;
+    return (this->getArea() <= Segment::maxLetterArea);
 }
 
 const bool
-Segment::isLetterC()
+Segment::isBigEnough()
 const
 {
-    const auto hu1 = this->getHuMomentInvariant(1);
-    const auto hu2 = this->getHuMomentInvariant(2);
-    const auto hu3 = this->getHuMomentInvariant(3);
-    const auto hu4 = this->getHuMomentInvariant(4);
-    const auto hu5 = this->getHuMomentInvariant(5);
-    const auto hu6 = this->getHuMomentInvariant(6);
-    const auto hu7 = this->getHuMomentInvariant(7);
-
-    if (hu1 < 0.346056 * 0.95 || hu1 > 0.619361 * 1.05) {
-        return false;
-    }
-    if (hu2 < 0.000357 * 0.95 || hu2 > 0.13103 * 1.05) {
-        return false;
-    }
-    if (hu3 < 0.00556 * 0.95 || hu3 > 0.070153 * 1.05) {
-        return false;
-    }
-    if (hu4 < 0.000056 * 0.95 || hu4 > 0.011795 * 1.05) {
-        return false;
-    }
-    if (hu5 < -0.000186 * 1.05 || hu5 > 0.000025 * 1.05) {
-        return false;
-    }
-    if (hu6 < -0.002186 * 1.05 || hu6 > -0.000081 * 0.95) {
-        return false;
-    }
-    if (hu7 < 0.029193 * 0.95 || hu7 > 0.063145 * 1.05) {
-        return false;
-    }
-
-    return true;
+    return (this->getArea() >= Segment::minLetterArea);
 }
 
 const bool
-Segment::isLetterO()
+Segment::isClassifiedAsLetter()
 const
 {
-    const auto hu1 = this->getHuMomentInvariant(1);
-    const auto hu2 = this->getHuMomentInvariant(2);
-    const auto hu3 = this->getHuMomentInvariant(3);
-    const auto hu4 = this->getHuMomentInvariant(4);
-    const auto hu5 = this->getHuMomentInvariant(5);
-    const auto hu6 = this->getHuMomentInvariant(6);
-    const auto hu7 = this->getHuMomentInvariant(7);
-
-    if (hu1 < 0.3217 * 0.95 || hu1 > 0.457977 * 1.05) {
-        return false;
-    }
-    if (hu2 < 0.001004 * 0.95 || hu2 > 0.024156 * 1.05) {
-        return false;
-    }
-    if (hu3 < 0.000000 || hu3 > 0.000085 * 1.05) {
-        return false;
-    }
-    if (hu4 < -0.000001 || hu4 > 0.000121 * 1.05) {
-        return false;
-    }
-    if (hu5 < -0.000001 || hu5 > 0.000001) {
-        return false;
-    }
-    if (hu6 < -0.000001 || hu6 > 0.000021 * 1.05) {
-        return false;
-    }
-    if (hu7 < 0.02311 * 0.95 || hu7 > 0.047001 * 1.05) {
-        return false;
-    }
-
-    return true;
+    return (this->classification == Classification::Letter);
 }
@@ -2,12 +2,15 @@
 #define POBR_IMGPROCESSING_STRUCTS_SEGMENT_HPP
 
 #include <cstdint>
+#include <array>
 #include <string>
 #include <vector>
 #include <utility>
 #include <opencv2/core/core.hpp>
 
 #include "../../utils/consts.hpp"
+#include "./Moments.hpp"
+#include "./Classifier.hpp"
 
 namespace consts = pobr::utils::consts;
 
@@ -16,6 +19,56 @@ namespace pobr::imgProcessing::structs
     struct Segment
     {
     public:
+        // Shape features, computed once when segment's pixels are set
+        struct Features
+        {
+            uint64_t area = 0;
+            // Raw moments up to order 3, relative to (xMin, yMin)
+            Moments moments;
+            // Note: left at zeros if moments are not exact (see Moments::isExact),
+            //       which never happens below area bounds of a letter,
+            //       and for segments rejected by the cheaper checks (see FilterStage)
+            std::array<double, 7> huInvariants = {};
+            // Log-scaled invariants, compared by the classifier (see Classifier::toFeatures)
+            Classifier::Features huFeatures = {};
+        };
+
+        enum class Classification: uint8_t
+        {
+            ErrorTooSmall,
+            ErrorTooBig,
+            ErrorUnknown,
+            // One of the classifier's letters (see getClassIdx)
+            Letter
+        };
+
+        // Checks a segment goes through when being classified, cheapest first,
+        // up to the first one rejecting it ("Passed" if none does)
+        enum class FilterStage: uint8_t
+        {
+            Area,
+            BBoxSize,
+            AspectRatio,
+            FillRatio,
+            // Within the span of all classes' first features (see Classifier::getFeatureSpan)
+            HuInvariant1,
+            // Near enough to the centroid of one of the classes (see Classifier::classify)
+            HuInvariants,
+            Passed
+        };
+
+        static const size_t filterStagesCount = 7;
+
+        // Area bounds of a segment that can be classified as a letter
+        static const uint64_t minLetterArea = 60;
+        static const uint64_t maxLetterArea = 3000;
+        // Note: bounds of the other cheaper checks come with the classifier's model
+        //       (see Classifier::Prefilter)
+
+        static const std::string getFilterStageName(const FilterStage& filterStage);
+
+        static const std::string getClassificationName(const Classification& classification);
+
         static const double getDistance(const Segment& left, const Segment& right);
 
         uint64_t xMin = 0;
@@ -23,12 +76,32 @@ namespace pobr::imgProcessing::structs
         uint64_t yMin = 0;
         uint64_t yMax = 0;
 
-        cv::Mat_<cv::Vec3b> pixels;
+        // Segment's ID within the label image its pixels come from
+        int label = 0;
 
         const void updateBoundaries(const uint64_t& x, const uint64_t& y);
-        const void updatePixels(const cv::Mat_<cv::Vec3i>& segmentedImg, const int& segmentID);
+        // Note: keeps a view of segmentedImg (within bounding box), does not copy it
+        const void updatePixels(const cv::Mat_<int>& segmentedImg, const int& segmentID);
+        // Same as above, but uses already known moments (relative to xMin, yMin)
+        // instead of computing them from the label image
+        const void updatePixels(const cv::Mat_<int>& segmentedImg, const int& segmentID, const Moments& moments);
+        // Features from already known moments alone (relative to xMin, yMin),
+        // for segments which need no view of their pixels (labels view stays empty)
+        const void updateMoments(const Moments& moments);
+
+        // Part of the label image within bounding box (shared, not a copy),
+        // segment's pixels are the ones equal to "label"
+        const cv::Mat_<int>& getLabelsView() const;
+        // Replaces the labels view with a copy of it, so the segment stays valid after
+        // its label image is reused (eg. scratch memory, see ImgProcessor::process)
+        const void detachLabelsView();
+        // Segment's pixels (white on black) within bounding box,
+        // built from the labels view on each call
+        const cv::Mat_<uint8_t> getPixels() const;
 
         const void merge(const Segment& other);
+        // Moves bounding box by (x, y), eg. from a part of the image to the whole of it
+        const void translate(const uint64_t& x, const uint64_t& y);
 
         const bool isValid() const;
         const uint64_t getWidth() const;
@@ -37,30 +110,41 @@ namespace pobr::imgProcessing::structs
         const std::pair<double, double> getGlobalCenter() const;
         const uint64_t getBBoxArea() const;
         const uint64_t getArea() const;
+        // Note: both come from segment's moments up to order 3 (see Features),
+        //       only higher orders walk its pixels
         const double getNormalMoment(const uint64_t& p, const uint64_t& q) const;
         const double getCentralMoment(const uint64_t& p, const uint64_t& q, const double& m00, const double& m10, const double& m01) const;
         const double getHuMomentInvariant(const uint8_t& no) const;
+        // All invariants, the way the classifier gets them, even for segments rejected
+        // before it (eg. for training, see FilterStage)
+        const std::array<double, 7> computeHuInvariants() const;
+        const Features& getFeatures() const;
 
-
-        const std::string classify() const;
+        const Classification classify() const;
+        // Index of segment's letter within the classifier's model (see Classifier::getModel),
+        // "-1" unless classified as a letter
+        const int getClassIdx() const;
+        // Check which rejected the segment (see FilterStage)
+        const FilterStage getFilterStage() const;
         const bool isSmallEnough() const;
         const bool isBigEnough() const;
         const bool isClassifiedAsLetter() const;
 
     protected:
-        const double getHuMomentInvariantNo1() const;
-        const double getHuMomentInvariantNo2() const;
-        const double getHuMomentInvariantNo3() const;
-        const double getHuMomentInvariantNo4() const;
-        const double getHuMomentInvariantNo5() const;
-        const double getHuMomentInvariantNo6() const;
-        const double getHuMomentInvariantNo7() const;
-
-        const bool isLetterT() const;
-        const bool isLetterE() const;
-        const bool isLetterS() const;
-        const bool isLetterC() const;
-        const bool isLetterO() const;
+        Features features;
+        Classification classification = Classification::ErrorTooSmall;
+        FilterStage filterStage = FilterStage::Area;
+        int classIdx = -1;
+
+        cv::Mat_<int> labelsView;
+
+        const void updateLabelsView(const cv::Mat_<int>& segmentedImg, const int& segmentID);
+        const void updateFeatures(const Moments& moments);
+        // First of the cheaper checks rejecting the segment, "HuInvariants" if none does
+        const FilterStage computeFilterStage() const;
+        const Classification computeClassification() const;
+        // Whether moment (p, q) is known from segment's moments, without a walk over its pixels
+        const bool hasExactMoment(const uint64_t& p, const uint64_t& q) const;
     };
 }
 
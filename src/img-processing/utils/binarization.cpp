@@ -1,5 +1,13 @@
 #include "./binarization.hpp"
 
+#include <algorithm>
+#include <limits>
+
+#if POBR_CONFIG_SIMD && (defined(__AVX2__) || defined(__SSSE3__))
+#define POBR_BINARIZATION_SIMD
+#include <immintrin.h>
+#endif
+
 #include "../../utils/consts.hpp"
 #include "./converters.hpp"
 #include "./matrix-ops.hpp"
@@ -10,17 +18,176 @@ namespace matrixOps = pobr::imgProcessing::utils::matrixOps;
 
 namespace binarization = pobr::imgProcessing::utils::binarization;
 
+namespace
+{
+    // Exactly what mixImageColors() + binarizeImage(threshold) compute for one BGR pixel
+    uint8_t mixAndBinarizePixel(const uint8_t* pixel, const cv::Vec3i& coefficients, const unsigned int& threshold)
+    {
+        int value = (
+            (((double) pixel[0]) * (((double) coefficients[0])) / 100) +
+            (((double) pixel[1]) * (((double) coefficients[1])) / 100) +
+            (((double) pixel[2]) * (((double) coefficients[2])) / 100)
+        );
+
+        value = std::min(value, 255);
+        value = std::max(value, 0);
+
+        return (value > threshold ? consts::colors::white : consts::colors::black);
+    }
+
+#ifdef POBR_BINARIZATION_SIMD
+    // Splits 16 interleaved BGR pixels into per-channel vectors
+    inline void deinterleavePixels16(const uint8_t* pixels, __m128i& blue, __m128i& green, __m128i& red)
+    {
+        const __m128i chunk0 = _mm_loadu_si128((const __m128i*) (pixels + 0));
+        const __m128i chunk1 = _mm_loadu_si128((const __m128i*) (pixels + 16));
+        const __m128i chunk2 = _mm_loadu_si128((const __m128i*) (pixels + 32));
+
+        blue = _mm_or_si128(
+            _mm_or_si128(
+                _mm_shuffle_epi8(chunk0, _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+                _mm_shuffle_epi8(chunk1, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1))
+            ),
+            _mm_shuffle_epi8(chunk2, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13))
+        );
+        green = _mm_or_si128(
+            _mm_or_si128(
+                _mm_shuffle_epi8(chunk0, _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+                _mm_shuffle_epi8(chunk1, _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1))
+            ),
+            _mm_shuffle_epi8(chunk2, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14))
+        );
+        red = _mm_or_si128(
+            _mm_or_si128(
+                _mm_shuffle_epi8(chunk0, _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+                _mm_shuffle_epi8(chunk1, _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1))
+            ),
+            _mm_shuffle_epi8(chunk2, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15))
+        );
+    }
+
+    // Mixes and thresholds 16 BGR pixels, using weights in 16-bit pairs: (blue, green) and (red, 0)
+    // Returns a bitmask of pixels whose weighted sum equals the bound exactly,
+    // those have to be resolved by mixAndBinarizePixel()
+    inline int mixAndBinarizePixels16(
+        const uint8_t* pixels,
+        uint8_t* result,
+        const int& blueGreenWeights,
+        const int& redWeights,
+        const int& bound
+    )
+    {
+        __m128i blue;
+        __m128i green;
+        __m128i red;
+
+        deinterleavePixels16(pixels, blue, green, red);
+
+#ifdef __AVX2__
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i blueGreenWeightsVec = _mm256_set1_epi32(blueGreenWeights);
+        const __m256i redWeightsVec = _mm256_set1_epi32(redWeights);
+        const __m256i boundVec = _mm256_set1_epi32(bound);
+        const __m256i boundMinusOneVec = _mm256_set1_epi32(bound - 1);
+
+        const __m256i blue16 = _mm256_cvtepu8_epi16(blue);
+        const __m256i green16 = _mm256_cvtepu8_epi16(green);
+        const __m256i red16 = _mm256_cvtepu8_epi16(red);
+
+        // Pixels 0-3 and 8-11
+        const __m256i sumsLo = _mm256_add_epi32(
+            _mm256_madd_epi16(_mm256_unpacklo_epi16(blue16, green16), blueGreenWeightsVec),
+            _mm256_madd_epi16(_mm256_unpacklo_epi16(red16, zero), redWeightsVec)
+        );
+        // Pixels 4-7 and 12-15
+        const __m256i sumsHi = _mm256_add_epi32(
+            _mm256_madd_epi16(_mm256_unpackhi_epi16(blue16, green16), blueGreenWeightsVec),
+            _mm256_madd_epi16(_mm256_unpackhi_epi16(red16, zero), redWeightsVec)
+        );
+
+        // In-lane packing restores the pixel order
+        const __m256i white16 = _mm256_packs_epi32(
+            _mm256_cmpgt_epi32(sumsLo, boundMinusOneVec),
+            _mm256_cmpgt_epi32(sumsHi, boundMinusOneVec)
+        );
+        const __m256i ties16 = _mm256_packs_epi32(
+            _mm256_cmpeq_epi32(sumsLo, boundVec),
+            _mm256_cmpeq_epi32(sumsHi, boundVec)
+        );
+
+        const __m128i white = _mm_packs_epi16(_mm256_castsi256_si128(white16), _mm256_extracti128_si256(white16, 1));
+        const __m128i ties = _mm_packs_epi16(_mm256_castsi256_si128(ties16), _mm256_extracti128_si256(ties16, 1));
+#else
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i blueGreenWeightsVec = _mm_set1_epi32(blueGreenWeights);
+        const __m128i redWeightsVec = _mm_set1_epi32(redWeights);
+        const __m128i boundVec = _mm_set1_epi32(bound);
+        const __m128i boundMinusOneVec = _mm_set1_epi32(bound - 1);
+
+        __m128i white8[2];
+        __m128i ties8[2];
+
+        for (int half = 0; half < 2; half++) {
+            const __m128i blue16 = (half == 0 ? _mm_unpacklo_epi8(blue, zero) : _mm_unpackhi_epi8(blue, zero));
+            const __m128i green16 = (half == 0 ? _mm_unpacklo_epi8(green, zero) : _mm_unpackhi_epi8(green, zero));
+            const __m128i red16 = (half == 0 ? _mm_unpacklo_epi8(red, zero) : _mm_unpackhi_epi8(red, zero));
+
+            const __m128i sumsLo = _mm_add_epi32(
+                _mm_madd_epi16(_mm_unpacklo_epi16(blue16, green16), blueGreenWeightsVec),
+                _mm_madd_epi16(_mm_unpacklo_epi16(red16, zero), redWeightsVec)
+            );
+            const __m128i sumsHi = _mm_add_epi32(
+                _mm_madd_epi16(_mm_unpackhi_epi16(blue16, green16), blueGreenWeightsVec),
+                _mm_madd_epi16(_mm_unpackhi_epi16(red16, zero), redWeightsVec)
+            );
+
+            white8[half] = _mm_packs_epi32(
+                _mm_cmpgt_epi32(sumsLo, boundMinusOneVec),
+                _mm_cmpgt_epi32(sumsHi, boundMinusOneVec)
+            );
+            ties8[half] = _mm_packs_epi32(
+                _mm_cmpeq_epi32(sumsLo, boundVec),
+                _mm_cmpeq_epi32(sumsHi, boundVec)
+            );
+        }
+
+        const __m128i white = _mm_packs_epi16(white8[0], white8[1]);
+        const __m128i ties = _mm_packs_epi16(ties8[0], ties8[1]);
+#endif
+
+        // Saturated -1 / 0 lanes are exactly white / black
+        _mm_storeu_si128((__m128i*) result, white);
+
+        return _mm_movemask_epi8(ties);
+    }
+#endif
+}
+
 cv::Mat
 binarization::mixImageColors(const cv::Mat& img, const cv::Vec3i& coefficients, const bool& preserveLuminosity)
 {
-    auto resultImg = img.clone();
+    cv::Mat resultImg;
 
-    matrixOps::forEachPixel(
+    binarization::mixImageColors(img, coefficients, preserveLuminosity, resultImg);
+
+    return resultImg;
+}
+
+const void
+binarization::mixImageColors(
+    const cv::Mat& img,
+    const cv::Vec3i& coefficients,
+    const bool& preserveLuminosity,
+    cv::Mat& resultImg
+)
+{
+    resultImg.create(img.rows, img.cols, CV_8UC1);
+
+    matrixOps::mapEachPixel<cv::Vec3b, uint8_t>(
         img,
-        [&](const uint64_t& x, const uint64_t& y) -> void
+        resultImg,
+        [&](const cv::Vec3b& thisPixel, uint8_t& resultPixel) -> void
         {
-            auto& thisPixel = img.at<cv::Vec3b>(y, x);
-
             int value = (
                 (((double) thisPixel[0]) * (((double) coefficients[0])) / 100) +
                 (((double) thisPixel[1]) * (((double) coefficients[1])) / 100) +
@@ -38,57 +205,158 @@ binarization::mixImageColors(const cv::Mat& img, const cv::Vec3i& coefficients,
             value = std::min(value, 255);
             value = std::max(value, 0);
 
-            resultImg.at<cv::Vec3b>(y, x)[0] = value;
-            resultImg.at<cv::Vec3b>(y, x)[1] = value;
-            resultImg.at<cv::Vec3b>(y, x)[2] = value;
+            resultPixel = value;
         }
     );
-
-    return resultImg;
 }
 
 cv::Mat
 binarization::binarizeImage(const cv::Mat& img, const unsigned int& threshold)
 {
-    auto resultImg = img.clone();
+    cv::Mat resultImg;
 
-    matrixOps::forEachPixel(
-        img,
-        [&](const uint64_t& x, const uint64_t& y) -> void
-        {
-            auto& thisPixel = img.at<cv::Vec3b>(y, x);
+    binarization::binarizeImage(img, threshold, resultImg);
+
+    return resultImg;
+}
 
-            uint8_t value;
+const void
+binarization::binarizeImage(const cv::Mat& img, const unsigned int& threshold, cv::Mat& resultImg)
+{
+    resultImg.create(img.rows, img.cols, CV_8UC1);
 
-            if (thisPixel[0] > threshold && thisPixel[1] > threshold && thisPixel[2] > threshold)
+    matrixOps::mapEachPixel<uint8_t, uint8_t>(
+        img,
+        resultImg,
+        [&](const uint8_t& thisPixel, uint8_t& resultPixel) -> void
+        {
+            if (thisPixel > threshold)
             {
-                value = 255;
+                resultPixel = consts::colors::white;
             }
             else
             {
-                value = 0;
+                resultPixel = consts::colors::black;
             }
-
-            resultImg.at<cv::Vec3b>(y, x)[0] = value;
-            resultImg.at<cv::Vec3b>(y, x)[1] = value;
-            resultImg.at<cv::Vec3b>(y, x)[2] = value;
         }
     );
+}
+
+cv::Mat
+binarization::mixAndBinarizeImage(const cv::Mat& img, const cv::Vec3i& coefficients, const unsigned int& threshold)
+{
+    cv::Mat resultImg;
+
+    binarization::mixAndBinarizeImage(img, coefficients, threshold, resultImg);
 
     return resultImg;
 }
 
+const void
+binarization::mixAndBinarizeImage(
+    const cv::Mat& img,
+    const cv::Vec3i& coefficients,
+    const unsigned int& threshold,
+    cv::Mat& resultImg
+)
+{
+    resultImg.create(img.rows, img.cols, CV_8UC1);
+
+    if (threshold >= 255) {
+        // Mixed values are clamped to 255, nothing can pass
+        resultImg.setTo(consts::colors::black);
+
+        return;
+    }
+
+    // Mixed value is truncated towards zero, so "value > threshold" holds
+    // exactly when (b * c0 + g * c1 + r * c2) >= 100 * (threshold + 1),
+    // except for exact ties, where the rounding of the original floating point sum decides
+    const int bound = 100 * (threshold + 1);
+
+#ifdef POBR_BINARIZATION_SIMD
+    const auto fitsInt16 = [](const int& value) -> bool
+    {
+        return (
+            value >= std::numeric_limits<int16_t>::min() &&
+            value <= std::numeric_limits<int16_t>::max()
+        );
+    };
+
+    const bool useSIMD = (
+        fitsInt16(coefficients[0]) &&
+        fitsInt16(coefficients[1]) &&
+        fitsInt16(coefficients[2])
+    );
+
+    const int blueGreenWeights = (
+        (coefficients[0] & 0xFFFF) |
+        (((uint32_t) coefficients[1]) << 16)
+    );
+    const int redWeights = (coefficients[2] & 0xFFFF);
+#endif
+
+    matrixOps::forEachRow<cv::Vec3b>(
+        img,
+        [&](const uint64_t& y, const cv::Vec3b* row) -> void
+        {
+            const auto srcRow = reinterpret_cast<const uint8_t*>(row);
+            auto resultRow = resultImg.ptr<uint8_t>(y);
+
+            int x = 0;
+
+#ifdef POBR_BINARIZATION_SIMD
+            for (; useSIMD && x + 16 <= img.cols; x += 16) {
+                const int ties = mixAndBinarizePixels16(
+                    srcRow + (3 * x),
+                    resultRow + x,
+                    blueGreenWeights,
+                    redWeights,
+                    bound
+                );
+
+                if (ties == 0) {
+                    continue;
+                }
+
+                for (int lane = 0; lane < 16; lane++) {
+                    if ((ties & (1 << lane)) == 0) {
+                        continue;
+                    }
+
+                    resultRow[x + lane] = mixAndBinarizePixel(srcRow + (3 * (x + lane)), coefficients, threshold);
+                }
+            }
+#endif
+
+            for (; x < img.cols; x++) {
+                const auto pixel = srcRow + (3 * x);
+                const int sum = (
+                    (pixel[0] * coefficients[0]) +
+                    (pixel[1] * coefficients[1]) +
+                    (pixel[2] * coefficients[2])
+                );
+
+                if (sum == bound) {
+                    resultRow[x] = mixAndBinarizePixel(pixel, coefficients, threshold);
+                } else {
+                    resultRow[x] = (sum > bound ? consts::colors::white : consts::colors::black);
+                }
+            }
+        }
+    );
+}
+
 cv::Mat
 binarization::binarizeImage(const cv::Mat& img, const cv::Vec3b& lowerBound, const cv::Vec3b& upperBound)
 {
-    auto resultImg = img.clone();
+    auto resultImg = cv::Mat(img.rows, img.cols, CV_8UC1);
 
-    matrixOps::forEachPixel(
+    matrixOps::mapEachPixel<cv::Vec3b, uint8_t>(
         img,
-        [&](const uint64_t& x, const uint64_t& y) -> void
+        resultImg,
+        [&](const cv::Vec3b& thisPixel, uint8_t& resultPixel) -> void
         {
-            auto& thisPixel = resultImg.at<cv::Vec3b>(y, x);
-
             uint8_t value = consts::colors::white;
 
             if (thisPixel[0] < lowerBound[0] || thisPixel[0] > upperBound[0]) {
@@ -101,9 +369,7 @@ binarization::binarizeImage(const cv::Mat& img, const cv::Vec3b& lowerBound, con
                 value = consts::colors::black;
             }
 
-            thisPixel[0] = value;
-            thisPixel[1] = value;
-            thisPixel[2] = value;
+            resultPixel = value;
         }
     );
 
@@ -115,16 +381,13 @@ binarization::invertBinaryImage(const cv::Mat& img)
 {
     auto resultImg = img.clone();
 
-    matrixOps::forEachPixel(
-        img,
-        [&](const uint64_t& x, const uint64_t& y) -> void
+    matrixOps::forEachRow<uint8_t>(
+        resultImg,
+        [&](const uint64_t& y, uint8_t* row) -> void
         {
-            auto& thisPixel = resultImg.at<cv::Vec3b>(y, x);
-            uint8_t value = 255 - thisPixel[0];
-
-            thisPixel[0] = value;
-            thisPixel[1] = value;
-            thisPixel[2] = value;
+            for (int x = 0; x < resultImg.cols; x++) {
+                row[x] = 255 - row[x];
+            }
         }
     );
 
@@ -134,8 +397,6 @@ binarization::invertBinaryImage(const cv::Mat& img)
 cv::Mat
 binarization::detectEdges(const cv::Mat& img)
 {
-    auto resultImg = img.clone();
-
     double kernelValues[9] = {
         -1, -1, -1,
         -1, 8, -1,
@@ -149,26 +410,24 @@ binarization::detectEdges(const cv::Mat& img)
         kernelValues
     );
 
-    resultImg = converters::grayscaleImage(resultImg);
+    auto resultImg = converters::grayscaleImage(img);
 
-    resultImg = matrixOps::applyKernel<cv::Vec3b, double, double>(
+    resultImg = matrixOps::applyKernel<uint8_t, double, double, 3, 3>(
         resultImg,
         kernel,
         0.0,
-        [](const uint64_t& x, const uint64_t& y, double& accumulator, const cv::Vec3b& pixel, const double& kernelValue) -> double
+        [](const uint64_t& x, const uint64_t& y, double& accumulator, const uint8_t& pixel, const double& kernelValue) -> double
         {
-            return accumulator + (kernelValue * pixel[0]);
+            return accumulator + (kernelValue * pixel);
         },
-        [](const uint64_t& x, const uint64_t& y, double& accumulator, cv::Vec3b& pixel, const cv::Mat& img) -> void
+        [](const uint64_t& x, const uint64_t& y, double& accumulator, uint8_t& pixel, const cv::Mat& img) -> void
         {
             double value = accumulator;
 
             value = std::min(value, 255.0);
             value = std::max(value, 0.0);
 
-            pixel[0] = value;
-            pixel[1] = value;
-            pixel[2] = value;
+            pixel = value;
         }
     );
 
@@ -1,12 +1,26 @@
 #ifndef POBR_IMGPROCESSING_UTILS_BINARIZATION_HPP
 #define POBR_IMGPROCESSING_UTILS_BINARIZATION_HPP
 
+#ifndef POBR_CONFIG_SIMD
+#define POBR_CONFIG_SIMD true
+#endif
+
 #include <opencv2/core/core.hpp>
 
 namespace pobr::imgProcessing::utils::binarization
 {
+    // Note: overloads taking "resultImg" write into it instead of allocating
+    //       (unless its size or type differs), so buffers and views can be reused
+
     cv::Mat mixImageColors(const cv::Mat& img, const cv::Vec3i& coefficients, const bool& preserveLuminosity);
+    const void mixImageColors(const cv::Mat& img, const cv::Vec3i& coefficients, const bool& preserveLuminosity, cv::Mat& resultImg);
+    // Note: can be applied in place (with "resultImg" being "img")
     cv::Mat binarizeImage(const cv::Mat& img, const unsigned int& threshold);
+    const void binarizeImage(const cv::Mat& img, const unsigned int& threshold, cv::Mat& resultImg);
+    // Same result as binarizeImage(mixImageColors(img, coefficients, false), threshold),
+    // computed in a single pass with integer arithmetic (and SSE / AVX2 when available)
+    cv::Mat mixAndBinarizeImage(const cv::Mat& img, const cv::Vec3i& coefficients, const unsigned int& threshold);
+    const void mixAndBinarizeImage(const cv::Mat& img, const cv::Vec3i& coefficients, const unsigned int& threshold, cv::Mat& resultImg);
     cv::Mat binarizeImage(const cv::Mat& img, const cv::Vec3b& lowerBound, const cv::Vec3b& upperBound);
     cv::Mat invertBinaryImage(const cv::Mat& img);
     cv::Mat detectEdges(const cv::Mat& img);
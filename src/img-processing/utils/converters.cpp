@@ -1,5 +1,6 @@
 #include "./converters.hpp"
 
+#include <vector>
 #include <algorithm>
 #include "./matrix-ops.hpp"
 
@@ -58,21 +59,111 @@ converters::rgb2HSV(const cv::Vec3b opencvRGB)
 cv::Mat
 converters::grayscaleImage(const cv::Mat& img)
 {
-    auto resultImg = img.clone();
+    cv::Mat resultImg;
 
-    matrixOps::forEachPixel(
+    converters::grayscaleImage(img, resultImg);
+
+    return resultImg;
+}
+
+const void
+converters::grayscaleImage(const cv::Mat& img, cv::Mat& resultImg)
+{
+    resultImg.create(img.rows, img.cols, CV_8UC1);
+
+    matrixOps::mapEachPixel<cv::Vec3b, uint8_t>(
         img,
-        [&](const uint64_t& x, const uint64_t& y) -> void
+        resultImg,
+        [](const cv::Vec3b& thisPixel, uint8_t& resultPixel) -> void
         {
-            auto& thisPixel = img.at<cv::Vec3b>(y, x);
+            resultPixel = (thisPixel[0] + thisPixel[1] + thisPixel[2]) / 3;
+        }
+    );
+}
 
-            uint8_t value = (thisPixel[0] + thisPixel[1] + thisPixel[2]) / 3;
+cv::Mat
+converters::expandGrayscaleImage(const cv::Mat& img)
+{
+    cv::Mat resultImg;
 
-            resultImg.at<cv::Vec3b>(y, x)[0] = value;
-            resultImg.at<cv::Vec3b>(y, x)[1] = value;
-            resultImg.at<cv::Vec3b>(y, x)[2] = value;
+    converters::expandGrayscaleImage(img, resultImg);
+
+    return resultImg;
+}
+
+const void
+converters::expandGrayscaleImage(const cv::Mat& img, cv::Mat& resultImg)
+{
+    resultImg.create(img.rows, img.cols, CV_8UC3);
+
+    matrixOps::mapEachPixel<uint8_t, cv::Vec3b>(
+        img,
+        resultImg,
+        [](const uint8_t& thisPixel, cv::Vec3b& resultPixel) -> void
+        {
+            resultPixel[0] = thisPixel;
+            resultPixel[1] = thisPixel;
+            resultPixel[2] = thisPixel;
         }
     );
+}
+
+cv::Mat
+converters::downscaleImage(const cv::Mat& img, const unsigned int& factor)
+{
+    cv::Mat resultImg;
+
+    converters::downscaleImage(img, factor, resultImg);
 
     return resultImg;
 }
+
+const void
+converters::downscaleImage(const cv::Mat& img, const unsigned int& factor, cv::Mat& resultImg)
+{
+    const unsigned int blockSize = std::max(1u, factor);
+    const uint32_t blockArea = blockSize * blockSize;
+    // Division by blockArea as a multiplication, exact as long as
+    // 255 * blockArea^2 < 2^32 (so for any factor up to 64)
+    const uint64_t blockAreaReciprocal = ((uint64_t(1) << 32) / blockArea) + 1;
+
+    const int rows = img.rows / blockSize;
+    const int cols = img.cols / blockSize;
+    const int sumsCount = cols * blockSize * 3;
+
+    resultImg.create(rows, cols, CV_8UC3);
+
+    // Column sums of the current block rows, kept as plain arrays of bytes' sums
+    // so the (by far heaviest) vertical pass runs over contiguous memory
+    std::vector<uint32_t> columnSums(sumsCount);
+
+    for (int y = 0; y < rows; y++) {
+        std::fill(columnSums.begin(), columnSums.end(), 0);
+
+        for (unsigned int blockY = 0; blockY < blockSize; blockY++) {
+            const uint8_t* row = img.ptr<uint8_t>((y * blockSize) + blockY);
+
+            for (int idx = 0; idx < sumsCount; idx++) {
+                columnSums[idx] += row[idx];
+            }
+        }
+
+        cv::Vec3b* resultRow = resultImg.ptr<cv::Vec3b>(y);
+
+        for (int x = 0; x < cols; x++) {
+            const uint32_t* blockSums = columnSums.data() + (x * blockSize * 3);
+
+            uint32_t sums[3] = { 0, 0, 0 };
+
+            for (unsigned int blockX = 0; blockX < blockSize; blockX++) {
+                sums[0] += blockSums[(blockX * 3) + 0];
+                sums[1] += blockSums[(blockX * 3) + 1];
+                sums[2] += blockSums[(blockX * 3) + 2];
+            }
+
+            resultRow[x][0] = (sums[0] * blockAreaReciprocal) >> 32;
+            resultRow[x][1] = (sums[1] * blockAreaReciprocal) >> 32;
+            resultRow[x][2] = (sums[2] * blockAreaReciprocal) >> 32;
+        }
+    }
+}
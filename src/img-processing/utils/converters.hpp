@@ -6,7 +6,16 @@
 namespace pobr::imgProcessing::utils::converters
 {
     cv::Vec3d rgb2HSV(const cv::Vec3b opencvRGB);
+    // Note: overloads taking "resultImg" write into it instead of allocating
+    //       (unless its size or type differs)
     cv::Mat grayscaleImage(const cv::Mat& img);
+    const void grayscaleImage(const cv::Mat& img, cv::Mat& resultImg);
+    cv::Mat expandGrayscaleImage(const cv::Mat& img);
+    const void expandGrayscaleImage(const cv::Mat& img, cv::Mat& resultImg);
+    // Averages each (factor x factor) block of a 3-channel image into one pixel,
+    // trailing rows and columns which do not fill a whole block are skipped
+    cv::Mat downscaleImage(const cv::Mat& img, const unsigned int& factor);
+    const void downscaleImage(const cv::Mat& img, const unsigned int& factor, cv::Mat& resultImg);
 }
 
 #endif
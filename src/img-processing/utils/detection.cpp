@@ -1,9 +1,168 @@
 #include "./detection.hpp"
 
+#include <cmath>
+#include <cstdint>
+#include <utility>
 #include <algorithm>
 
 namespace detection = pobr::imgProcessing::utils::detection;
 
+namespace
+{
+    typedef std::pair<double, double> Point;
+
+    // Letters of a single class, along with their (precomputed) global centers
+    struct Letters
+    {
+        std::vector<const structs::Segment*> segments;
+        std::vector<Point> centers;
+
+        uint64_t maxWidth = 0;
+
+        void add(const structs::Segment& segment)
+        {
+            this->segments.push_back(&segment);
+            this->centers.push_back(segment.getGlobalCenter());
+            this->maxWidth = std::max(this->maxWidth, segment.getWidth());
+        }
+    };
+
+    // Uniform grid over points, for rectangle range queries
+    // Cell size is picked so there is about one point per cell
+    struct PointsGrid
+    {
+        double originX = 0;
+        double originY = 0;
+        double cellSize = 1;
+        int64_t cols = 0;
+        int64_t rows = 0;
+
+        std::vector<std::vector<uint32_t>> cells;
+
+        explicit PointsGrid(const std::vector<Point>& points)
+        {
+            if (points.empty()) {
+                return;
+            }
+
+            double maxX = points[0].first;
+            double maxY = points[0].second;
+
+            this->originX = points[0].first;
+            this->originY = points[0].second;
+
+            for (const auto& point: points) {
+                this->originX = std::min(this->originX, point.first);
+                this->originY = std::min(this->originY, point.second);
+                maxX = std::max(maxX, point.first);
+                maxY = std::max(maxY, point.second);
+            }
+
+            const double extentX = (maxX - this->originX + 1);
+            const double extentY = (maxY - this->originY + 1);
+
+            // Note: bounded by the longer extent as well, so there are never more than
+            //       about 3x as many cells as points, even if points lie along a line
+            this->cellSize = std::max({
+                1.0,
+                std::sqrt((extentX * extentY) / points.size()),
+                std::max(extentX, extentY) / points.size()
+            });
+            this->cols = this->getCell(maxX, this->originX, INT64_MAX) + 1;
+            this->rows = this->getCell(maxY, this->originY, INT64_MAX) + 1;
+
+            this->cells.resize(this->cols * this->rows);
+
+            for (uint32_t idx = 0; idx < points.size(); idx++) {
+                const auto cellX = this->getCell(points[idx].first, this->originX, this->cols - 1);
+                const auto cellY = this->getCell(points[idx].second, this->originY, this->rows - 1);
+
+                this->cells[(cellY * this->cols) + cellX].push_back(idx);
+            }
+        }
+
+        // Note: monotonic, so a point within a range never falls outside of range's cells
+        int64_t getCell(const double& value, const double& origin, const int64_t& maxCell) const
+        {
+            const double cell = std::floor((value - origin) / this->cellSize);
+
+            if (cell < 0) {
+                return 0;
+            }
+            if (cell > maxCell) {
+                return maxCell;
+            }
+
+            return cell;
+        }
+
+        // Calls visitor(idx) for every point which may lie within [xMin, xMax] x [yMin, yMax]
+        // (a superset, the visitor does exact checks), stops once visitor returns true
+        // Returns whether any visitor call did
+        template<class Visitor>
+        bool query(
+            const double& xMin,
+            const double& xMax,
+            const double& yMin,
+            const double& yMax,
+            Visitor&& visitor
+        ) const
+        {
+            if (this->cells.empty() || xMin > xMax || yMin > yMax) {
+                return false;
+            }
+
+            const auto cellXMin = this->getCell(xMin, this->originX, this->cols - 1);
+            const auto cellXMax = this->getCell(xMax, this->originX, this->cols - 1);
+            const auto cellYMin = this->getCell(yMin, this->originY, this->rows - 1);
+            const auto cellYMax = this->getCell(yMax, this->originY, this->rows - 1);
+
+            for (int64_t cellY = cellYMin; cellY <= cellYMax; cellY++) {
+                for (int64_t cellX = cellXMin; cellX <= cellXMax; cellX++) {
+                    for (const auto& idx: this->cells[(cellY * this->cols) + cellX]) {
+                        if (visitor(idx)) {
+                            return true;
+                        }
+                    }
+                }
+            }
+
+            return false;
+        }
+    };
+
+    // Whether any letter's center lies within [xMin, xMax] x [yMin, yMax]
+    bool hasLetterWithin(
+        const Letters& letters,
+        const PointsGrid& grid,
+        const double& xMin,
+        const double& xMax,
+        const double& yMin,
+        const double& yMax
+    )
+    {
+        return grid.query(
+            xMin,
+            xMax,
+            yMin,
+            yMax,
+            [&](const uint32_t& idx) -> bool
+            {
+                const auto& center = letters.centers[idx];
+
+                if (center.first < xMin || center.first > xMax) {
+                    return false;
+                }
+                if (center.second < yMin || center.second > yMax) {
+                    return false;
+                }
+
+                return true;
+            }
+        );
+    }
+}
+
 std::vector<structs::Segment> 
 detection::groupLetters(
     const std::vector<structs::Segment>& segments
@@ -11,50 +170,74 @@ detection::groupLetters(
 {
     std::vector<structs::Segment> boundingBoxes;
 
-    std::vector<structs::Segment> lettersT;
-    std::vector<structs::Segment> lettersE;
-    std::vector<structs::Segment> lettersS;
-    std::vector<structs::Segment> lettersC;
-    std::vector<structs::Segment> lettersO;
+    const auto& model = structs::Classifier::getModel();
+    const auto& word = model.getWord();
 
-    for (const auto& segment: segments) {
-        const auto classification = segment.classify();
+    // Indexed by class
+    std::vector<Letters> letters(model.getClassesCount());
+    std::vector<PointsGrid> grids;
 
-        if (classification == "LETTER_T") {
-            lettersT.push_back(segment);
-            continue;
-        }
-        if (classification == "LETTER_E") {
-            lettersE.push_back(segment);
-            continue;
-        }
-        if (classification == "LETTER_S") {
-            lettersS.push_back(segment);
-            continue;
-        }
-        if (classification == "LETTER_C") {
-            lettersC.push_back(segment);
-            continue;
-        }
-        if (classification == "LETTER_O") {
-            lettersO.push_back(segment);
+    for (const auto& segment: segments) {
+        if (!segment.isClassifiedAsLetter()) {
             continue;
         }
+
+        letters[segment.getClassIdx()].add(segment);
     }
 
-    for (const auto& segmentT: lettersT) {
-        for (const auto& segmentO: lettersO) {
-            // Do not detect mirrored images
-            const auto tGlobalCenter = segmentT.getGlobalCenter();
-            const auto oGlobalCenter = segmentO.getGlobalCenter();
+    grids.reserve(letters.size());
+
+    for (const auto& classLetters: letters) {
+        grids.emplace_back(classLetters.centers);
+    }
+
+    const auto& firstLetters = letters[word.front()];
+    const auto& lastLetters = letters[word.back()];
+    const auto& lastGrid = grids[word.back()];
+
+    // Average letter widths between first and last letters' centers
+    const double gapsCount = word.size() - 1;
+
+    std::vector<uint32_t> nearbyLastLetters;
+
+    for (size_t idxFirst = 0; idxFirst < firstLetters.segments.size(); idxFirst++) {
+        const auto& segmentFirst = *(firstLetters.segments[idxFirst]);
+        const auto& firstGlobalCenter = firstLetters.centers[idxFirst];
+
+        // Last letters further away than (1.2 * gapsCount * avgWidth) are never paired,
+        // look only within that distance (with a margin for rounding)
+        const double maxDistance = (0.6 * gapsCount * (segmentFirst.getWidth() + lastLetters.maxWidth)) + 1;
+
+        nearbyLastLetters.clear();
+
+        lastGrid.query(
+            firstGlobalCenter.first - 1,
+            firstGlobalCenter.first + maxDistance,
+            firstGlobalCenter.second - maxDistance,
+            firstGlobalCenter.second + maxDistance,
+            [&](const uint32_t& idx) -> bool
+            {
+                nearbyLastLetters.push_back(idx);
+
+                return false;
+            }
+        );
+
+        // Keep the original pairing order
+        std::sort(nearbyLastLetters.begin(), nearbyLastLetters.end());
 
-            if (tGlobalCenter.first - oGlobalCenter.first > 0) {
+        for (const auto& idxLast: nearbyLastLetters) {
+            const auto& segmentLast = *(lastLetters.segments[idxLast]);
+            const auto& lastGlobalCenter = lastLetters.centers[idxLast];
+
+            // Do not detect mirrored images
+            if (firstGlobalCenter.first - lastGlobalCenter.first > 0) {
                 continue;
             }
 
-            const auto distance = structs::Segment::getDistance(segmentT, segmentO);
-            const auto avgWidth = ((double) (segmentT.getWidth() + segmentO.getWidth())) / 2;
-            const auto expectedDistance = avgWidth * 4;
+            const auto distance = structs::Segment::getDistance(segmentFirst, segmentLast);
+            const auto avgWidth = ((double) (segmentFirst.getWidth() + segmentLast.getWidth())) / 2;
+            const auto expectedDistance = avgWidth * gapsCount;
 
             const auto ratio = distance / expectedDistance;
 
@@ -64,134 +247,134 @@ detection::groupLetters(
             }
 
             // Interpolate possible places for next letters
-            structs::Segment segmentE;
-            structs::Segment segmentS;
-            structs::Segment segmentC;
+            const auto xDiff = ((double) (lastGlobalCenter.first - firstGlobalCenter.first)) / gapsCount;
+            const auto yDiff = ((double) (lastGlobalCenter.second - firstGlobalCenter.second)) / gapsCount;
 
-            const auto xDiff = ((double) (oGlobalCenter.first - tGlobalCenter.first)) / 4;
-            const auto yDiff = ((double) (oGlobalCenter.second - tGlobalCenter.second)) / 4;
-
-            // - Find letter E
+            // Looks for a letter centered around (first letter's center + step * diff)
+            const auto hasLetterAt = [&](const size_t& classIdx, const double& step) -> bool
             {
-                const auto expectedCenterXMin = tGlobalCenter.first + (xDiff * 0) + (xDiff * -1.5); 
-                const auto expectedCenterXMax = tGlobalCenter.first + (xDiff * 0) + (xDiff * 1.5); 
-                const auto expectedCenterYMin = tGlobalCenter.second + (yDiff * 0) + ((yDiff > 0 ? yDiff + 1 : yDiff - 1) * (yDiff > 0 ? -1.5 : 1.5)); 
-                const auto expectedCenterYMax = tGlobalCenter.second + (yDiff * 0) + ((yDiff > 0 ? yDiff + 1 : yDiff - 1) * (yDiff > 0 ? 1.5 : -1.5)); 
+                const auto expectedCenterXMin = firstGlobalCenter.first + (xDiff * step) + (xDiff * -1.5);
+                const auto expectedCenterXMax = firstGlobalCenter.first + (xDiff * step) + (xDiff * 1.5);
+                const auto expectedCenterYMin = firstGlobalCenter.second + (yDiff * step) + ((yDiff > 0 ? yDiff + 1 : yDiff - 1) * (yDiff > 0 ? -1.5 : 1.5));
+                const auto expectedCenterYMax = firstGlobalCenter.second + (yDiff * step) + ((yDiff > 0 ? yDiff + 1 : yDiff - 1) * (yDiff > 0 ? 1.5 : -1.5));
+
+                return hasLetterWithin(
+                    letters[classIdx],
+                    grids[classIdx],
+                    expectedCenterXMin,
+                    expectedCenterXMax,
+                    expectedCenterYMin,
+                    expectedCenterYMax
+                );
+            };
+
+            bool hasAllLetters = true;
+
+            // Note: letter at position "idx" is looked for at step (idx - 1), as it always was for "TESCO"
+            for (size_t idx = 1; idx + 1 < word.size() && hasAllLetters; idx++) {
+                hasAllLetters = hasLetterAt(word[idx], idx - 1);
+            }
 
-                for (const auto& thisSegment: lettersE) {
-                    const auto thisGlobalCenter = thisSegment.getGlobalCenter();
+            if (!hasAllLetters) {
+                continue;
+            }
 
-                    if (thisGlobalCenter.first < expectedCenterXMin) {
-                        continue;
-                    }
-                    if (thisGlobalCenter.first > expectedCenterXMax) {
-                        continue;
-                    }
-                    if (thisGlobalCenter.second < expectedCenterYMin) {
-                        continue;
-                    }
-                    if (thisGlobalCenter.second > expectedCenterYMax) {
-                        continue;
-                    }
+            // Found all letters, store bounding box
+            structs::Segment bbox;
 
-                    segmentE = thisSegment;
+            bbox.xMin = segmentFirst.xMin;
+            bbox.xMax = segmentLast.xMax;
 
-                    break;
-                }
-
-                if (!segmentE.isValid()) {
-                    continue;
-                }
+            if (firstGlobalCenter.second < lastGlobalCenter.second) {
+                // Top to bottom
+                bbox.yMin = segmentFirst.yMin;
+                bbox.yMax = segmentLast.yMax;
+            } else {
+                // Bottom to top
+                bbox.yMin = segmentLast.yMin;
+                bbox.yMax = segmentFirst.yMax;
             }
 
-            // - Find letter S
-            {
-                const auto expectedCenterXMin = tGlobalCenter.first + (xDiff * 1) + (xDiff * -1.5); 
-                const auto expectedCenterXMax = tGlobalCenter.first + (xDiff * 1) + (xDiff * 1.5); 
-                const auto expectedCenterYMin = tGlobalCenter.second + (yDiff * 1) + ((yDiff > 0 ? yDiff + 1 : yDiff - 1) * (yDiff > 0 ? -1.5 : 1.5)); 
-                const auto expectedCenterYMax = tGlobalCenter.second + (yDiff * 1) + ((yDiff > 0 ? yDiff + 1 : yDiff - 1) * (yDiff > 0 ? 1.5 : -1.5)); 
+            boundingBoxes.push_back(bbox);
+        }
+    }
 
-                for (const auto& thisSegment: lettersS) {
-                    const auto thisGlobalCenter = thisSegment.getGlobalCenter();
+    return boundingBoxes;
+}
 
-                    if (thisGlobalCenter.first < expectedCenterXMin) {
-                        continue;
-                    }
-                    if (thisGlobalCenter.first > expectedCenterXMax) {
-                        continue;
-                    }
-                    if (thisGlobalCenter.second < expectedCenterYMin) {
-                        continue;
-                    }
-                    if (thisGlobalCenter.second > expectedCenterYMax) {
-                        continue;
-                    }
+std::vector<cv::Rect>
+detection::mergeRegions(
+    const std::vector<cv::Rect>& regions,
+    std::vector<size_t>* regionsIdxs
+)
+{
+    // Merged regions with indexes of the input ones they are made of,
+    // no two of them overlap after each step
+    std::vector<std::pair<cv::Rect, std::vector<size_t>>> mergedRegions;
 
-                    segmentS = thisSegment;
+    for (size_t regionIdx = 0; regionIdx < regions.size(); regionIdx++) {
+        auto region = std::make_pair(regions[regionIdx], std::vector<size_t>{ regionIdx });
 
-                    break;
-                }
+        // Merge with every region it overlaps, until no overlaps are left
+        // Note: grown region may overlap ones it did not overlap before
+        bool hasMerged = true;
 
-                if (!segmentS.isValid()) {
+        while (hasMerged) {
+            hasMerged = false;
+
+            for (size_t idx = 0; idx < mergedRegions.size(); idx++) {
+                if ((region.first & mergedRegions[idx].first).area() == 0) {
                     continue;
                 }
-            }
 
-            // - Find letter C
-            {
-                const auto expectedCenterXMin = tGlobalCenter.first + (xDiff * 2) + (xDiff * -1.5); 
-                const auto expectedCenterXMax = tGlobalCenter.first + (xDiff * 2) + (xDiff * 1.5); 
-                const auto expectedCenterYMin = tGlobalCenter.second + (yDiff * 2) + ((yDiff > 0 ? yDiff + 1 : yDiff - 1) * (yDiff > 0 ? -1.5 : 1.5)); 
-                const auto expectedCenterYMax = tGlobalCenter.second + (yDiff * 2) + ((yDiff > 0 ? yDiff + 1 : yDiff - 1) * (yDiff > 0 ? 1.5 : -1.5)); 
+                region.first = region.first | mergedRegions[idx].first;
+                region.second.insert(
+                    region.second.end(),
+                    mergedRegions[idx].second.begin(),
+                    mergedRegions[idx].second.end()
+                );
 
-                for (const auto& thisSegment: lettersC) {
-                    const auto thisGlobalCenter = thisSegment.getGlobalCenter();
+                mergedRegions[idx] = std::move(mergedRegions.back());
+                mergedRegions.pop_back();
 
-                    if (thisGlobalCenter.first < expectedCenterXMin) {
-                        continue;
-                    }
-                    if (thisGlobalCenter.first > expectedCenterXMax) {
-                        continue;
-                    }
-                    if (thisGlobalCenter.second < expectedCenterYMin) {
-                        continue;
-                    }
-                    if (thisGlobalCenter.second > expectedCenterYMax) {
-                        continue;
-                    }
-
-                    segmentC = thisSegment;
+                hasMerged = true;
+                break;
+            }
+        }
 
-                    break;
-                }
+        mergedRegions.push_back(std::move(region));
+    }
 
-                if (!segmentC.isValid()) {
-                    continue;
-                }
-            }
+    std::sort(
+        mergedRegions.begin(),
+        mergedRegions.end(),
+        [](const std::pair<cv::Rect, std::vector<size_t>>& left, const std::pair<cv::Rect, std::vector<size_t>>& right) -> bool
+        {
+            return (
+                left.first.y != right.first.y ?
+                left.first.y < right.first.y :
+                left.first.x < right.first.x
+            );
+        }
+    );
 
-            // Found all letters, store bounding box and skip to next T letter
-            structs::Segment bbox;
+    std::vector<cv::Rect> results;
 
-            bbox.xMin = segmentT.xMin;
-            bbox.xMax = segmentO.xMax;
+    if (regionsIdxs != nullptr) {
+        regionsIdxs->assign(regions.size(), 0);
+    }
 
-            if (tGlobalCenter.second < oGlobalCenter.second) {
-                // Top to bottom
-                bbox.yMin = segmentT.yMin;
-                bbox.yMax = segmentO.yMax;
-            } else {
-                // Bottom to top
-                bbox.yMin = segmentO.yMin;
-                bbox.yMax = segmentT.yMax;
-            }
+    for (size_t idx = 0; idx < mergedRegions.size(); idx++) {
+        results.push_back(mergedRegions[idx].first);
 
-            // Note: possible slight optimisation
-            //       remove used letters from containers to prevent re-checking them
+        if (regionsIdxs == nullptr) {
+            continue;
+        }
 
-            boundingBoxes.push_back(bbox);
+        for (const auto& regionIdx: mergedRegions[idx].second) {
+            (*regionsIdxs)[regionIdx] = idx;
         }
     }
 
-    return boundingBoxes;
+    return results;
 }
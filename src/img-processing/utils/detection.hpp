@@ -2,6 +2,7 @@
 #define POBR_IMGPROCESSING_UTILS_DETECTION_HPP
 
 #include <vector>
+#include <opencv2/core/core.hpp>
 
 #include "../structs/Segment.hpp"
 
@@ -9,9 +10,20 @@ namespace structs = pobr::imgProcessing::structs;
 
 namespace pobr::imgProcessing::utils::detection
 {
+    // Bounding boxes of the classifier's word (see Classifier::getWord), made of letters
+    // evenly spaced between a first and a last letter about a letter width apart per gap
     std::vector<structs::Segment> groupLetters(
         const std::vector<structs::Segment>& segments
     );
+
+    // Joins overlapping regions, until none of them overlap,
+    // sorted by their top left corners (rows first) to keep results' order stable
+    // Note: "regionsIdxs", if given, gets the index of the merged region
+    //       each of the input ones ended up in
+    std::vector<cv::Rect> mergeRegions(
+        const std::vector<cv::Rect>& regions,
+        std::vector<size_t>* regionsIdxs = nullptr
+    );
 }
 
 #endif
@@ -1,5 +1,6 @@
 #include "./enhance.hpp"
 
+#include <array>
 #include <algorithm>
 
 #include "../../utils/consts.hpp"
@@ -13,143 +14,115 @@ namespace enhance = pobr::imgProcessing::utils::enhance;
 cv::Mat
 enhance::erodeImage(const cv::Mat& img, const unsigned int& windowSize)
 {
-    auto resultImg = img.clone();
+    cv::Mat resultImg;
 
-    auto kernel = cv::Mat(
-        windowSize,
-        windowSize,
-        CV_64F
-    );
+    enhance::erodeImage(img, windowSize, resultImg);
 
-    double erosionThreshold = 1.0 * (windowSize * windowSize) * consts::colors::white;
+    return resultImg;
+}
 
-    // Initialize kernel values
-    for (unsigned int i = 0; i < windowSize; i++) {
-        for (unsigned int j = 0; j < windowSize; j++) {
-            kernel.at<double>(j, i) = 1;
-        }
-    }
+const void
+enhance::erodeImage(const cv::Mat& img, const unsigned int& windowSize, cv::Mat& resultImg)
+{
+    double erosionThreshold = 1.0 * (windowSize * windowSize) * consts::colors::white;
 
-    resultImg = matrixOps::applyKernel<cv::Vec3b, double, double>(
+    matrixOps::applyBoxKernel<uint8_t>(
+        img,
         resultImg,
-        kernel,
-        0.0,
-        [](const uint64_t& x, const uint64_t& y, double& accumulator, const cv::Vec3b& pixel, const double& kernelValue) -> double
-        {
-            return accumulator + (kernelValue * pixel[0]);
-        },
-        [&erosionThreshold](const uint64_t& x, const uint64_t& y, double& accumulator, cv::Vec3b& pixel, const cv::Mat& img) -> void
+        windowSize,
+        windowSize,
+        [&erosionThreshold](const uint64_t& x, const uint64_t& y, const std::array<double, 1>& sums, uint8_t& pixel, const cv::Mat& img) -> void
         {
             double value = consts::colors::black;
 
-            if (accumulator == erosionThreshold) {
+            if (sums[0] == erosionThreshold) {
                 value = consts::colors::white;
             }
 
-            pixel[0] = value;
-            pixel[1] = value;
-            pixel[2] = value;
+            pixel = value;
         }
     );
-
-    return resultImg;
 }
 
 cv::Mat
 enhance::dilateImage(const cv::Mat& img, const unsigned int& windowSize)
 {
-    auto resultImg = img.clone();
+    cv::Mat resultImg;
 
-    auto kernel = cv::Mat(
-        windowSize,
-        windowSize,
-        CV_64F
-    );
+    enhance::dilateImage(img, windowSize, resultImg);
 
-    // Initialize kernel values
-    for (unsigned int i = 0; i < windowSize; i++) {
-        for (unsigned int j = 0; j < windowSize; j++) {
-            kernel.at<double>(j, i) = 1;
-        }
-    }
+    return resultImg;
+}
 
-    resultImg = matrixOps::applyKernel<cv::Vec3b, double, double>(
+const void
+enhance::dilateImage(const cv::Mat& img, const unsigned int& windowSize, cv::Mat& resultImg)
+{
+    matrixOps::applyBoxKernel<uint8_t>(
+        img,
         resultImg,
-        kernel,
-        0.0,
-        [](const uint64_t& x, const uint64_t& y, double& accumulator, const cv::Vec3b& pixel, const double& kernelValue) -> double
-        {
-            return accumulator + (kernelValue * pixel[0]);
-        },
-        [](const uint64_t& x, const uint64_t& y, double& accumulator, cv::Vec3b& pixel, const cv::Mat& img) -> void
+        windowSize,
+        windowSize,
+        [](const uint64_t& x, const uint64_t& y, const std::array<double, 1>& sums, uint8_t& pixel, const cv::Mat& img) -> void
         {
             double value = consts::colors::black;
 
-            if (accumulator > 0) {
+            if (sums[0] > 0) {
                 value = consts::colors::white;
             }
 
-            pixel[0] = value;
-            pixel[1] = value;
-            pixel[2] = value;
+            pixel = value;
         }
     );
-
-    return resultImg;
 }
 
 cv::Mat
 enhance::unsharpMasking(const cv::Mat& img)
 {
-    auto resultImg = img.clone();
-
-    double kernelValues[25] = {
-        1,  4,    6,  4, 1,
-        4, 16,   24, 16, 4,
-        6, 24, -476, 24, 6,
-        4, 16,   24, 16, 4,
-        1,  4,    6,  4, 1        
-    };
-
-    auto kernel = cv::Mat(
-        5,
-        5,
-        CV_64F,
-        kernelValues
-    );
+    cv::Mat resultImg;
 
-    std::array<double, 3> accumulatorInit = { { 0.0, 0.0, 0.0 } };
+    enhance::unsharpMasking(img, resultImg);
 
-    resultImg = matrixOps::applyKernel<cv::Vec3b, std::array<double, 3>, double>(
+    return resultImg;
+}
+
+const void
+enhance::unsharpMasking(const cv::Mat& img, cv::Mat& resultImg)
+{
+    // Kernel used:
+    //   1,  4,    6,  4, 1,
+    //   4, 16,   24, 16, 4,
+    //   6, 24, -476, 24, 6,
+    //   4, 16,   24, 16, 4,
+    //   1,  4,    6,  4, 1
+    // which equals (binomial * binomial^T) with 512 subtracted in the center,
+    // so it is applied as a separable kernel and a center pixel correction
+    double binomialValues[5] = { 1, 4, 6, 4, 1 };
+    const double centerCorrection = 512;
+
+    auto rowKernel = cv::Mat(1, 5, CV_64F, binomialValues);
+    auto colKernel = cv::Mat(5, 1, CV_64F, binomialValues);
+
+    matrixOps::applySeparableKernel<cv::Vec3b>(
+        img,
         resultImg,
-        kernel,
-        accumulatorInit,
-        [](const uint64_t& x, const uint64_t& y, std::array<double, 3>& accumulator, const cv::Vec3b& pixel, const double& kernelValue) -> std::array<double, 3>
+        rowKernel,
+        colKernel,
+        [&centerCorrection](const uint64_t& x, const uint64_t& y, const std::array<double, 3>& sums, cv::Vec3b& pixel, const cv::Mat& img) -> void
         {
-            accumulator[0] = accumulator[0] + (kernelValue * pixel[0]);
-            accumulator[1] = accumulator[1] + (kernelValue * pixel[1]);
-            accumulator[2] = accumulator[2] + (kernelValue * pixel[2]);
+            std::array<double, 3> accumulator;
 
-            return accumulator;
-        },
-        [](const uint64_t& x, const uint64_t& y, std::array<double, 3>& accumulator, cv::Vec3b& pixel, const cv::Mat& img) -> void
-        {
-            accumulator[0] = accumulator[0] / 256 * -1;
-            accumulator[1] = accumulator[1] / 256 * -1;
-            accumulator[2] = accumulator[2] / 256 * -1;
+            // Note: pixel still holds its original value at this point
+            for (int channel = 0; channel < 3; channel++) {
+                accumulator[channel] = sums[channel] - (centerCorrection * pixel[channel]);
+                accumulator[channel] = accumulator[channel] / 256 * -1;
 
-            accumulator[0] = std::min(accumulator[0], 255.0);
-            accumulator[0] = std::max(accumulator[0], 0.0);
-            accumulator[1] = std::min(accumulator[1], 255.0);
-            accumulator[1] = std::max(accumulator[1], 0.0);
-            accumulator[2] = std::min(accumulator[2], 255.0);
-            accumulator[2] = std::max(accumulator[2], 0.0);
+                accumulator[channel] = std::min(accumulator[channel], 255.0);
+                accumulator[channel] = std::max(accumulator[channel], 0.0);
+            }
 
             pixel[0] = accumulator[0];
             pixel[1] = accumulator[1];
             pixel[2] = accumulator[2];
         }
     );
-
-    return resultImg;
 }
@@ -5,9 +5,14 @@
 
 namespace pobr::imgProcessing::utils::enhance
 {
+    // Note: overloads taking "resultImg" write into it instead of allocating
+    //       (unless its size or type differs), it must not share data with "img"
     cv::Mat erodeImage(const cv::Mat& img, const unsigned int& windowSize);
+    const void erodeImage(const cv::Mat& img, const unsigned int& windowSize, cv::Mat& resultImg);
     cv::Mat dilateImage(const cv::Mat& img, const unsigned int& windowSize);
+    const void dilateImage(const cv::Mat& img, const unsigned int& windowSize, cv::Mat& resultImg);
     cv::Mat unsharpMasking(const cv::Mat& img);
+    const void unsharpMasking(const cv::Mat& img, cv::Mat& resultImg);
 }
 
 #endif
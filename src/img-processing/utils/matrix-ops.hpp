@@ -2,30 +2,135 @@
 #define POBR_IMGPROCESSING_UTILS_MATRIXOPS_HPP
 
 #include <cstdint>
-#include <functional>
+#include <array>
 #include <opencv2/core/core.hpp>
 
 namespace pobr::imgProcessing::utils::matrixOps
 {
+    // Note: all iterators walk the matrix row by row (the way OpenCV stores it)
+    //       and accept any callable, so operations can be inlined
+
+    // Calls operation(x, y) for each pixel
+    template<class Operation>
     const cv::Mat& forEachPixel(
         const cv::Mat& img,
-        const std::function<void(const uint64_t& x, const uint64_t& y)>& operation
+        Operation&& operation
+    );
+
+    // Calls operation(y, row) for each row, where row points at the first pixel
+    // of that row, and pixels are stored consecutively (img.cols of them)
+    template<class PixelClass, class Operation>
+    const cv::Mat& forEachRow(
+        const cv::Mat& img,
+        Operation&& operation
+    );
+    template<class PixelClass, class Operation>
+    cv::Mat& forEachRow(
+        cv::Mat& img,
+        Operation&& operation
+    );
+
+    // Calls operation(srcPixel, dstPixel) for each pair of pixels at the same position,
+    // both matrices have to be of the same size
+    template<class SrcPixelClass, class DstPixelClass, class Operation>
+    cv::Mat& mapEachPixel(
+        const cv::Mat& src,
+        cv::Mat& dst,
+        Operation&& operation
     );
 
-    template<class Acc>
+    // Calls accumulator = operation(x, y, accumulator) for each pixel
+    template<class Acc, class Operation>
     Acc reduceEachPixel(
         const cv::Mat& img,
         Acc accumulator,
-        const std::function<Acc(const uint64_t& x, const uint64_t& y, Acc& accumulator)>& operation
+        Operation&& operation
     );
 
-    template<class PixelClass, class Acc, class KernelValue>
+    // Uniform per-channel access to single- and multi-channel pixels
+    template<class PixelClass>
+    struct PixelChannels
+    {
+        static const int count = 1;
+
+        static double get(const PixelClass& pixel, const int& channel)
+        {
+            return pixel;
+        }
+    };
+    template<class Value, int Count>
+    struct PixelChannels<cv::Vec<Value, Count>>
+    {
+        static const int count = Count;
+
+        static double get(const cv::Vec<Value, Count>& pixel, const int& channel)
+        {
+            return pixel[channel];
+        }
+    };
+
+    // Note: kernels below either return a new image, or write into "resultImg",
+    //       which is (re)allocated only if its size or type differs (see cv::Mat::create)
+    //       and must not share data with "img", as kernels read neighbouring pixels
+
+    // Generic kernel application, with edge cropping
+    // Note: passing kernel size as KernelRows / KernelCols fixes it at compile time,
+    //       so the inner loops get fully unrolled
+    template<class PixelClass, class Acc, class KernelValue, int KernelRows = 0, int KernelCols = 0, class Reducer, class Applicator>
     cv::Mat applyKernel(
         const cv::Mat& img,
         const cv::Mat& kernel,
         Acc accumulatorInit,
-        const std::function<Acc(const uint64_t& x, const uint64_t& y, Acc& accumulator, const PixelClass& pixel, const KernelValue& kernelValue)>& reducer,
-        const std::function<void(const uint64_t& x, const uint64_t& y, Acc& accumulator, PixelClass& pixel, const cv::Mat& img)>& applicator
+        Reducer&& reducer,
+        Applicator&& applicator
+    );
+    template<class PixelClass, class Acc, class KernelValue, int KernelRows = 0, int KernelCols = 0, class Reducer, class Applicator>
+    cv::Mat& applyKernel(
+        const cv::Mat& img,
+        cv::Mat& resultImg,
+        const cv::Mat& kernel,
+        Acc accumulatorInit,
+        Reducer&& reducer,
+        Applicator&& applicator
+    );
+
+    // Applies a kernel made of ones only (box window), with edge cropping
+    // Calls applicator(x, y, sums, pixel, img), where sums holds the window sum of each channel;
+    // cost per pixel does not depend on window size
+    template<class PixelClass, class Applicator>
+    cv::Mat applyBoxKernel(
+        const cv::Mat& img,
+        const unsigned int& kernelRows,
+        const unsigned int& kernelCols,
+        Applicator&& applicator
+    );
+    template<class PixelClass, class Applicator>
+    cv::Mat& applyBoxKernel(
+        const cv::Mat& img,
+        cv::Mat& resultImg,
+        const unsigned int& kernelRows,
+        const unsigned int& kernelCols,
+        Applicator&& applicator
+    );
+
+    // Applies a kernel equal to (colKernel * rowKernel), with edge cropping,
+    // as a row pass followed by a column pass
+    // rowKernel is a 1xN CV_64F matrix, colKernel is a Mx1 CV_64F matrix
+    // Calls applicator(x, y, sums, pixel, img), where sums holds the weighted sum of each channel
+    template<class PixelClass, class Applicator>
+    cv::Mat applySeparableKernel(
+        const cv::Mat& img,
+        const cv::Mat& rowKernel,
+        const cv::Mat& colKernel,
+        Applicator&& applicator
+    );
+    template<class PixelClass, class Applicator>
+    cv::Mat& applySeparableKernel(
+        const cv::Mat& img,
+        cv::Mat& resultImg,
+        const cv::Mat& rowKernel,
+        const cv::Mat& colKernel,
+        Applicator&& applicator
     );
 }
 
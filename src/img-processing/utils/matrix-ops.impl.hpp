@@ -3,18 +3,102 @@
 
 #include "./matrix-ops.hpp"
 
+#include <vector>
+#include <utility>
+
 namespace matrixOps = pobr::imgProcessing::utils::matrixOps;
 
-template<class Acc>
+template<class Operation>
+const cv::Mat&
+matrixOps::forEachPixel(
+    const cv::Mat& img,
+    Operation&& operation
+)
+{
+    const uint64_t rows = img.rows;
+    const uint64_t cols = img.cols;
+
+    for (uint64_t y = 0; y < rows; y++) {
+        for (uint64_t x = 0; x < cols; x++) {
+            operation(x, y);
+        }
+    }
+
+    return img;
+}
+
+template<class PixelClass, class Operation>
+const cv::Mat&
+matrixOps::forEachRow(
+    const cv::Mat& img,
+    Operation&& operation
+)
+{
+    const uint64_t rows = img.rows;
+
+    for (uint64_t y = 0; y < rows; y++) {
+        const PixelClass* row = img.ptr<PixelClass>(y);
+
+        operation(y, row);
+    }
+
+    return img;
+}
+
+template<class PixelClass, class Operation>
+cv::Mat&
+matrixOps::forEachRow(
+    cv::Mat& img,
+    Operation&& operation
+)
+{
+    const uint64_t rows = img.rows;
+
+    for (uint64_t y = 0; y < rows; y++) {
+        PixelClass* row = img.ptr<PixelClass>(y);
+
+        operation(y, row);
+    }
+
+    return img;
+}
+
+template<class SrcPixelClass, class DstPixelClass, class Operation>
+cv::Mat&
+matrixOps::mapEachPixel(
+    const cv::Mat& src,
+    cv::Mat& dst,
+    Operation&& operation
+)
+{
+    const int rows = src.rows;
+    const int cols = src.cols;
+
+    for (int y = 0; y < rows; y++) {
+        const SrcPixelClass* srcRow = src.ptr<SrcPixelClass>(y);
+        DstPixelClass* dstRow = dst.ptr<DstPixelClass>(y);
+
+        for (int x = 0; x < cols; x++) {
+            operation(srcRow[x], dstRow[x]);
+        }
+    }
+
+    return dst;
+}
+
+template<class Acc, class Operation>
 Acc
 matrixOps::reduceEachPixel(
     const cv::Mat& img,
     Acc accumulator,
-    const std::function<Acc(const uint64_t& x, const uint64_t& y, Acc& accumulator)>& operation
+    Operation&& operation
 )
 {
-    for (uint64_t x = 0; x < img.cols; x++) {
-        for (uint64_t y = 0; y < img.rows; y++) {
+    const uint64_t rows = img.rows;
+    const uint64_t cols = img.cols;
+
+    for (uint64_t y = 0; y < rows; y++) {
+        for (uint64_t x = 0; x < cols; x++) {
             accumulator = operation(x, y, accumulator);
         }
     }
@@ -22,67 +106,302 @@ matrixOps::reduceEachPixel(
     return accumulator;
 }
 
-template<class PixelClass, class Acc, class KernelValue>
+template<class PixelClass, class Acc, class KernelValue, int KernelRows, int KernelCols, class Reducer, class Applicator>
 cv::Mat
 matrixOps::applyKernel(
     const cv::Mat& img,
     const cv::Mat& kernel,
     Acc accumulatorInit,
-    const std::function<Acc(const uint64_t& x, const uint64_t& y, Acc& accumulator, const PixelClass& pixel, const KernelValue& kernelValue)>& reducer,
-    const std::function<void(const uint64_t& x, const uint64_t& y, Acc& accumulator, PixelClass& pixel, const cv::Mat& img)>& applicator
+    Reducer&& reducer,
+    Applicator&& applicator
+)
+{
+    cv::Mat resultImg;
+
+    matrixOps::applyKernel<PixelClass, Acc, KernelValue, KernelRows, KernelCols>(
+        img,
+        resultImg,
+        kernel,
+        accumulatorInit,
+        std::forward<Reducer>(reducer),
+        std::forward<Applicator>(applicator)
+    );
+
+    return resultImg;
+}
+
+template<class PixelClass, class Acc, class KernelValue, int KernelRows, int KernelCols, class Reducer, class Applicator>
+cv::Mat&
+matrixOps::applyKernel(
+    const cv::Mat& img,
+    cv::Mat& resultImg,
+    const cv::Mat& kernel,
+    Acc accumulatorInit,
+    Reducer&& reducer,
+    Applicator&& applicator
 )
 {
     // Uses edge cropping
-    auto resultImg = img.clone();
+    img.copyTo(resultImg);
 
-    const unsigned int initRow = 0 + ((kernel.rows - 1) / 2);
-    const unsigned int initCol = 0 + ((kernel.cols - 1) / 2);
+    const int kernelRows = (KernelRows > 0 ? KernelRows : kernel.rows);
+    const int kernelCols = (KernelCols > 0 ? KernelCols : kernel.cols);
 
-    const unsigned int endRow = (img.rows - 1) - initRow;
-    const unsigned int endCol = (img.cols - 1) - initCol;
+    const int kernelOffsetY = ((kernelRows - 1) / 2);
+    const int kernelOffsetX = ((kernelCols - 1) / 2);
 
-    const unsigned int kernelOffsetY = 0 + ((kernel.rows - 1) / 2);
-    const unsigned int kernelOffsetX = 0 + ((kernel.cols - 1) / 2);
+    const int initRow = kernelOffsetY;
+    const int initCol = kernelOffsetX;
 
-    matrixOps::forEachPixel(
-        resultImg,
-        [&](const uint64_t& x, const uint64_t& y) -> void
-        {
-            if (x < initCol) {
-                return;
+    // Note: even-sized kernels reach one pixel further to the bottom-right
+    const int endRow = (img.rows - kernelRows) + kernelOffsetY;
+    const int endCol = (img.cols - kernelCols) + kernelOffsetX;
+
+    for (int y = initRow; y <= endRow; y++) {
+        PixelClass* resultRow = resultImg.ptr<PixelClass>(y);
+
+        for (int x = initCol; x <= endCol; x++) {
+            Acc value = accumulatorInit;
+
+            for (int kernelY = 0; kernelY < kernelRows; kernelY++) {
+                const KernelValue* kernelRow = kernel.ptr<KernelValue>(kernelY);
+                const PixelClass* adjacentRow = img.ptr<PixelClass>(y - kernelOffsetY + kernelY) + (x - kernelOffsetX);
+
+                for (int kernelX = 0; kernelX < kernelCols; kernelX++) {
+                    value = reducer(x, y, value, adjacentRow[kernelX], kernelRow[kernelX]);
+                }
             }
-            if (y < initRow) {
-                return;
+
+            applicator(x, y, value, resultRow[x], img);
+        }
+    }
+
+    return resultImg;
+}
+
+template<class PixelClass, class Applicator>
+cv::Mat
+matrixOps::applyBoxKernel(
+    const cv::Mat& img,
+    const unsigned int& kernelRows,
+    const unsigned int& kernelCols,
+    Applicator&& applicator
+)
+{
+    cv::Mat resultImg;
+
+    matrixOps::applyBoxKernel<PixelClass>(
+        img,
+        resultImg,
+        kernelRows,
+        kernelCols,
+        std::forward<Applicator>(applicator)
+    );
+
+    return resultImg;
+}
+
+template<class PixelClass, class Applicator>
+cv::Mat&
+matrixOps::applyBoxKernel(
+    const cv::Mat& img,
+    cv::Mat& resultImg,
+    const unsigned int& kernelRows,
+    const unsigned int& kernelCols,
+    Applicator&& applicator
+)
+{
+    typedef PixelChannels<PixelClass> Channels;
+    typedef std::array<double, Channels::count> Sums;
+
+    // Uses edge cropping
+    img.copyTo(resultImg);
+
+    const int kernelOffsetY = ((kernelRows - 1) / 2);
+    const int kernelOffsetX = ((kernelCols - 1) / 2);
+
+    const int windowsPerRow = (img.cols - (int) kernelCols) + 1;
+    const int windowsPerCol = (img.rows - (int) kernelRows) + 1;
+
+    if (windowsPerRow < 1 || windowsPerCol < 1) {
+        return resultImg;
+    }
+
+    // Running sums of each column over the current window rows,
+    // moved one row down at a time
+    std::vector<Sums> columnSums(img.cols, Sums());
+
+    const auto addRow = [&](const int& y, const double& sign) -> void
+    {
+        const PixelClass* row = img.ptr<PixelClass>(y);
+
+        for (int x = 0; x < img.cols; x++) {
+            for (int channel = 0; channel < Channels::count; channel++) {
+                columnSums[x][channel] += sign * Channels::get(row[x], channel);
             }
-            if (x > endCol) {
-                return;
+        }
+    };
+
+    for (unsigned int y = 0; y < kernelRows - 1; y++) {
+        addRow(y, 1);
+    }
+
+    for (int windowY = 0; windowY < windowsPerCol; windowY++) {
+        addRow(windowY + kernelRows - 1, 1);
+
+        if (windowY > 0) {
+            addRow(windowY - 1, -1);
+        }
+
+        const int y = windowY + kernelOffsetY;
+        PixelClass* resultRow = resultImg.ptr<PixelClass>(y);
+
+        Sums sums = Sums();
+
+        for (unsigned int x = 0; x < kernelCols - 1; x++) {
+            for (int channel = 0; channel < Channels::count; channel++) {
+                sums[channel] += columnSums[x][channel];
             }
-            if (y > endRow) {
-                return;
+        }
+
+        for (int windowX = 0; windowX < windowsPerRow; windowX++) {
+            const auto& enteringSums = columnSums[windowX + kernelCols - 1];
+
+            for (int channel = 0; channel < Channels::count; channel++) {
+                sums[channel] += enteringSums[channel];
             }
 
-            Acc value = matrixOps::reduceEachPixel<Acc>(
-                kernel,
-                accumulatorInit,
-                [&](const uint64_t& kernelX, const uint64_t& kernelY, Acc& accumulator) -> Acc
-                {
-                    auto& thisKernelValue = kernel.at<KernelValue>(kernelY, kernelX);
-                    auto& adjacentPixel = img.at<PixelClass>(
-                        y - kernelOffsetY + kernelY,
-                        x - kernelOffsetX + kernelX
-                    );
-
-                    return reducer(x, y, accumulator, adjacentPixel, thisKernelValue);
+            if (windowX > 0) {
+                const auto& leavingSums = columnSums[windowX - 1];
+
+                for (int channel = 0; channel < Channels::count; channel++) {
+                    sums[channel] -= leavingSums[channel];
                 }
-            );
+            }
 
-            auto& thisPixel = resultImg.at<PixelClass>(y, x);
+            const int x = windowX + kernelOffsetX;
 
-            applicator(x, y, value, thisPixel, img);
+            applicator(x, y, sums, resultRow[x], img);
         }
+    }
+
+    return resultImg;
+}
+
+template<class PixelClass, class Applicator>
+cv::Mat
+matrixOps::applySeparableKernel(
+    const cv::Mat& img,
+    const cv::Mat& rowKernel,
+    const cv::Mat& colKernel,
+    Applicator&& applicator
+)
+{
+    cv::Mat resultImg;
+
+    matrixOps::applySeparableKernel<PixelClass>(
+        img,
+        resultImg,
+        rowKernel,
+        colKernel,
+        std::forward<Applicator>(applicator)
     );
 
     return resultImg;
 }
 
+template<class PixelClass, class Applicator>
+cv::Mat&
+matrixOps::applySeparableKernel(
+    const cv::Mat& img,
+    cv::Mat& resultImg,
+    const cv::Mat& rowKernel,
+    const cv::Mat& colKernel,
+    Applicator&& applicator
+)
+{
+    typedef PixelChannels<PixelClass> Channels;
+    typedef std::array<double, Channels::count> Sums;
+
+    // Uses edge cropping
+    img.copyTo(resultImg);
+
+    const int kernelRows = colKernel.rows;
+    const int kernelCols = rowKernel.cols;
+
+    const int kernelOffsetY = ((kernelRows - 1) / 2);
+    const int kernelOffsetX = ((kernelCols - 1) / 2);
+
+    const int windowsPerRow = (img.cols - kernelCols) + 1;
+    const int windowsPerCol = (img.rows - kernelRows) + 1;
+
+    if (windowsPerRow < 1 || windowsPerCol < 1) {
+        return resultImg;
+    }
+
+    std::vector<double> rowWeights(kernelCols);
+    std::vector<double> colWeights(kernelRows);
+
+    for (int i = 0; i < kernelCols; i++) {
+        rowWeights[i] = rowKernel.at<double>(0, i);
+    }
+    for (int i = 0; i < kernelRows; i++) {
+        colWeights[i] = colKernel.at<double>(i, 0);
+    }
+
+    // Results of the row pass, only the last kernelRows image rows are kept,
+    // image row "y" lives at (y % kernelRows)
+    std::vector<std::vector<Sums>> rowPassRing(
+        kernelRows,
+        std::vector<Sums>(windowsPerRow)
+    );
+
+    const auto rowPass = [&](const int& y) -> void
+    {
+        const PixelClass* row = img.ptr<PixelClass>(y);
+        auto& rowPassResult = rowPassRing[y % kernelRows];
+
+        for (int windowX = 0; windowX < windowsPerRow; windowX++) {
+            Sums sums = Sums();
+
+            for (int kernelX = 0; kernelX < kernelCols; kernelX++) {
+                for (int channel = 0; channel < Channels::count; channel++) {
+                    sums[channel] += rowWeights[kernelX] * Channels::get(row[windowX + kernelX], channel);
+                }
+            }
+
+            rowPassResult[windowX] = sums;
+        }
+    };
+
+    for (int y = 0; y < kernelRows - 1; y++) {
+        rowPass(y);
+    }
+
+    for (int windowY = 0; windowY < windowsPerCol; windowY++) {
+        rowPass(windowY + kernelRows - 1);
+
+        const int y = windowY + kernelOffsetY;
+        PixelClass* resultRow = resultImg.ptr<PixelClass>(y);
+
+        for (int windowX = 0; windowX < windowsPerRow; windowX++) {
+            Sums sums = Sums();
+
+            for (int kernelY = 0; kernelY < kernelRows; kernelY++) {
+                const auto& rowPassSums = rowPassRing[(windowY + kernelY) % kernelRows][windowX];
+
+                for (int channel = 0; channel < Channels::count; channel++) {
+                    sums[channel] += colWeights[kernelY] * rowPassSums[channel];
+                }
+            }
+
+            const int x = windowX + kernelOffsetX;
+
+            applicator(x, y, sums, resultRow[x], img);
+        }
+    }
+
+    return resultImg;
+}
+
 #endif
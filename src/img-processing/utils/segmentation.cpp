@@ -1,8 +1,9 @@
 #include "./segmentation.hpp"
 
-#include <stack>
-#include <unordered_map>
-#include <unordered_set>
+#include <atomic>
+#include <limits>
+#include <utility>
+#include <algorithm>
 
 #include "../../utils/consts.hpp"
 #include "./matrix-ops.hpp"
@@ -12,168 +13,776 @@ namespace matrixOps = pobr::imgProcessing::utils::matrixOps;
 
 namespace segmentation = pobr::imgProcessing::utils::segmentation;
 
-std::vector<structs::Segment>
-segmentation::getImageSegmentsScanMerge(const cv::Mat& img, const bool& useDiagonalDetection)
+using Moments = pobr::imgProcessing::structs::Moments;
+using ThreadPool = pobr::utils::ThreadPool;
+
+namespace
 {
-    auto segmentsIDs = cv::Mat(
-        img.rows,
-        img.cols,
-        CV_64F,
-        0.0
-    );
-    std::vector<structs::Segment> segmentsBoundaries;
-    std::unordered_map<double, std::unordered_set<double>> touchingSegments;
+    // Note: a set's root is always its smallest label,
+    //       so every parent has a lower label than its children
+    inline int32_t findRootLabel(std::vector<int32_t>& parents, int32_t label)
+    {
+        int32_t root = label;
 
-    double lookupKernelValues[9] = {
-        0, 1, 0,
-        1, 0, 1,
-        0, 1, 0     
-    };
+        while (parents[root] != root) {
+            root = parents[root];
+        }
 
-    if (useDiagonalDetection) {
-        lookupKernelValues[0] = 1;
-        lookupKernelValues[2] = 1;
-        lookupKernelValues[6] = 1;
-        lookupKernelValues[8] = 1;
+        // Path compression
+        while (parents[label] != root) {
+            const int32_t parent = parents[label];
+
+            parents[label] = root;
+            label = parent;
+        }
+
+        return root;
     }
 
-    auto lookupKernel = cv::Mat(
-        3,
-        3,
-        CV_64F,
-        lookupKernelValues
-    );
+    inline int32_t mergeLabels(std::vector<int32_t>& parents, const int32_t& left, const int32_t& right)
+    {
+        const int32_t leftRoot = findRootLabel(parents, left);
+        const int32_t rightRoot = findRootLabel(parents, right);
 
-    // Note: Kernel application skips img edges
-    //       replace with forEachPixel maybe?
-    matrixOps::applyKernel<double, double, double>(
-        segmentsIDs,
-        lookupKernel,
-        0,
-        [&](const uint64_t& x, const uint64_t& y, double& accumulator, const double& segmentID, const double& kernelValue) -> double
-        {
-            const auto& imgPixel = img.at<cv::Vec3b>(y, x);
+        if (leftRoot < rightRoot) {
+            parents[rightRoot] = leftRoot;
+
+            return leftRoot;
+        }
+
+        parents[leftRoot] = rightRoot;
+
+        return rightRoot;
+    }
+
+    inline int32_t createLabel(std::vector<int32_t>& parents)
+    {
+        const int32_t label = parents.size();
+
+        parents.push_back(label);
+
+        return label;
+    }
+
+    // Lock-free variants, for label sets shared between threads
+    // Note: keeps the "parent has a lower label" rule as well
+    inline int32_t findSharedRootLabel(std::atomic<int32_t>* parents, int32_t label)
+    {
+        while (true) {
+            const int32_t parent = parents[label].load();
 
-            if (imgPixel[0] == consts::colors::black) {
-                // Short-circuit as there is nothing to do here
-                return 0;
+            if (parent == label) {
+                return label;
             }
 
-            if (kernelValue == 0) {
-                return accumulator;
+            // Path halving, losing this race is harmless
+            const int32_t grandParent = parents[parent].load();
+            int32_t expected = parent;
+
+            parents[label].compare_exchange_weak(expected, grandParent);
+
+            label = grandParent;
+        }
+    }
+
+    inline void mergeSharedLabels(std::atomic<int32_t>* parents, const int32_t& left, const int32_t& right)
+    {
+        while (true) {
+            int32_t leftRoot = findSharedRootLabel(parents, left);
+            int32_t rightRoot = findSharedRootLabel(parents, right);
+
+            if (leftRoot == rightRoot) {
+                return;
+            }
+            if (leftRoot > rightRoot) {
+                std::swap(leftRoot, rightRoot);
+            }
+
+            // Retry if rightRoot has been linked elsewhere in the meantime
+            int32_t expected = rightRoot;
+
+            if (parents[rightRoot].compare_exchange_strong(expected, leftRoot)) {
+                return;
+            }
+        }
+    }
+
+    // Turns label sets into consecutive final labels (in order of their roots),
+    // finalLabels[label] is set for every label, returns the number of final labels
+    int32_t flattenLabels(const std::vector<int32_t>& parents, std::vector<int32_t>& finalLabels)
+    {
+        int32_t finalLabelsCount = 0;
+
+        finalLabels.assign(parents.size(), 0);
+
+        for (size_t label = 1; label < parents.size(); label++) {
+            if (parents[label] == (int32_t) label) {
+                finalLabels[label] = ++finalLabelsCount;
+            } else {
+                finalLabels[label] = finalLabels[parents[label]];
             }
+        }
+
+        return finalLabelsCount;
+    }
+
+    // Assigns provisional labels to rows [rowBegin, rowEnd) and records which of them touch,
+    // looking only at already visited neighbours (previous row and the left one)
+    // Note: rows before rowBegin are treated as background
+    void labelRows(
+        const cv::Mat& img,
+        cv::Mat_<int>& segmentedImg,
+        const int& rowBegin,
+        const int& rowEnd,
+        std::vector<int32_t>& parents,
+        const bool& diagDetection
+    )
+    {
+        const int cols = img.cols;
+
+        for (int y = rowBegin; y < rowEnd; y++) {
+            const uint8_t* row = img.ptr<uint8_t>(y);
+            int32_t* labelsRow = segmentedImg.ptr<int32_t>(y);
+            const int32_t* prevLabelsRow = (y > rowBegin ? segmentedImg.ptr<int32_t>(y - 1) : nullptr);
+
+            for (int x = 0; x < cols; x++) {
+                if (row[x] != consts::colors::white) {
+                    labelsRow[x] = 0;
+
+                    continue;
+                }
+
+                const int32_t left = (x > 0 ? labelsRow[x - 1] : 0);
+                const int32_t up = (prevLabelsRow != nullptr ? prevLabelsRow[x] : 0);
+
+                int32_t label = 0;
 
-            if (accumulator != 0) {
-                if (segmentID == 0 || accumulator == segmentID) {
-                    return accumulator;
+                if (!diagDetection) {
+                    if (up != 0 && left != 0) {
+                        label = (up == left ? up : mergeLabels(parents, up, left));
+                    } else if (up != 0) {
+                        label = up;
+                    } else if (left != 0) {
+                        label = left;
+                    } else {
+                        label = createLabel(parents);
+                    }
+                } else {
+                    const int32_t upLeft = (prevLabelsRow != nullptr && x > 0 ? prevLabelsRow[x - 1] : 0);
+                    const int32_t upRight = (prevLabelsRow != nullptr && x < cols - 1 ? prevLabelsRow[x + 1] : 0);
+
+                    // Note: "up" touches all other visited neighbours,
+                    //       so they are already known to be connected
+                    if (up != 0) {
+                        label = up;
+                    } else if (upRight != 0) {
+                        label = upRight;
+
+                        if (upLeft != 0) {
+                            label = mergeLabels(parents, upRight, upLeft);
+                        } else if (left != 0) {
+                            label = mergeLabels(parents, upRight, left);
+                        }
+                    } else if (upLeft != 0) {
+                        label = upLeft;
+                    } else if (left != 0) {
+                        label = left;
+                    } else {
+                        label = createLabel(parents);
+                    }
                 }
 
-                // Segments touching, store that information for merging phase
-                touchingSegments.at(accumulator).insert(segmentID);
-                touchingSegments.at(segmentID).insert(accumulator);
+                labelsRow[x] = label;
+            }
+        }
+    }
+
+    // Sums of x, x^2 and x^3 over [0, n], modulo 2^64 (just like moments)
+    // Note: divisions are done before multiplications, so intermediate results never wrap before them
+    inline uint64_t sumOfPowers1(const uint64_t& n)
+    {
+        return (n % 2 == 0 ? (n / 2) * (n + 1) : n * ((n + 1) / 2));
+    }
+
+    inline uint64_t sumOfPowers2(const uint64_t& n)
+    {
+        // n * (n + 1) * (2n + 1) / 6
+        uint64_t factors[3] = { n, n + 1, (2 * n) + 1 };
+
+        factors[(n % 2 == 0 ? 0 : 1)] /= 2;
+
+        for (auto& factor: factors) {
+            if (factor % 3 == 0) {
+                factor /= 3;
+
+                break;
+            }
+        }
+
+        return factors[0] * factors[1] * factors[2];
+    }
+
+    inline uint64_t sumOfPowers3(const uint64_t& n)
+    {
+        const uint64_t sum = sumOfPowers1(n);
+
+        return sum * sum;
+    }
+
+    struct ComponentStats
+    {
+        uint64_t xMin = std::numeric_limits<uint64_t>::max();
+        uint64_t xMax = 0;
+        uint64_t yMin = std::numeric_limits<uint64_t>::max();
+        uint64_t yMax = 0;
+
+        Moments moments;
+
+        // Sums of the row currently being scanned, added to moments once it's done
+        int64_t rowY = -1;
+        uint64_t rowCount = 0;
+        uint64_t rowSumX = 0;
+        uint64_t rowSumX2 = 0;
+        uint64_t rowSumX3 = 0;
+
+        // Note: pixels have to be added row by row, top to bottom
+        inline void addPixel(const uint64_t& x, const uint64_t& y)
+        {
+            if ((int64_t) y != this->rowY) {
+                this->flushRow();
+                this->rowY = y;
+            }
+
+            if (x < this->xMin) {
+                this->xMin = x;
+            }
+            if (x > this->xMax) {
+                this->xMax = x;
             }
+            if (y < this->yMin) {
+                this->yMin = y;
+            }
+            this->yMax = y;
+
+            this->rowCount += 1;
+            this->rowSumX += x;
+            this->rowSumX2 += x * x;
+            this->rowSumX3 += x * x * x;
+        }
+
+        // Same as addPixel, but pixels can come in any order (eg. from a flood fill)
+        inline void addUnorderedPixel(const uint64_t& x, const uint64_t& y)
+        {
+            this->xMin = std::min(this->xMin, x);
+            this->xMax = std::max(this->xMax, x);
+            this->yMin = std::min(this->yMin, y);
+            this->yMax = std::max(this->yMax, y);
 
-            return segmentID;
-        },
-        [&](const uint64_t& x, const uint64_t& y, double& accumulator, double& setSegmentID, const cv::Mat& tt) -> void
+            this->moments.addPixel(y, x);
+        }
+
+        // Adds pixels [xFirst, xLast] of row "y" at once
+        inline void addRun(const uint64_t& xFirst, const uint64_t& xLast, const uint64_t& y)
         {
-            const auto& imgPixel = img.at<cv::Vec3b>(y, x);
+            if ((int64_t) y != this->rowY) {
+                this->flushRow();
+                this->rowY = y;
+            }
+
+            if (xFirst < this->xMin) {
+                this->xMin = xFirst;
+            }
+            if (xLast > this->xMax) {
+                this->xMax = xLast;
+            }
+            if (y < this->yMin) {
+                this->yMin = y;
+            }
+            this->yMax = y;
 
-            if (imgPixel[0] == consts::colors::black) {
-                // Short-circuit as there is nothing to do here
+            this->rowCount += (xLast - xFirst + 1);
+            this->rowSumX += sumOfPowers1(xLast) - sumOfPowers1(xFirst - 1);
+            this->rowSumX2 += sumOfPowers2(xLast) - sumOfPowers2(xFirst - 1);
+            this->rowSumX3 += sumOfPowers3(xLast) - sumOfPowers3(xFirst - 1);
+        }
+
+        inline void flushRow()
+        {
+            if (this->rowCount == 0) {
                 return;
             }
 
-            if (accumulator == 0) {
-                // Not IDed yet, create new segment
+            this->moments.addRow(this->rowY, this->rowCount, this->rowSumX, this->rowSumX2, this->rowSumX3);
 
-                const auto thisSegmentID = segmentsBoundaries.size() + 1;
-                structs::Segment newSegment;
+            this->rowCount = 0;
+            this->rowSumX = 0;
+            this->rowSumX2 = 0;
+            this->rowSumX3 = 0;
+        }
 
-                newSegment.xMin = x;
-                newSegment.xMax = x;
-                newSegment.yMin = y;
-                newSegment.yMax = y;
+        // Both stats have to be flushed already
+        inline void merge(const ComponentStats& other)
+        {
+            this->xMin = std::min(this->xMin, other.xMin);
+            this->xMax = std::max(this->xMax, other.xMax);
+            this->yMin = std::min(this->yMin, other.yMin);
+            this->yMax = std::max(this->yMax, other.yMax);
 
-                segmentsIDs.at<double>(y, x) = thisSegmentID;
-                segmentsBoundaries.push_back(newSegment);
-                touchingSegments.insert({ thisSegmentID, {} });
-            } else {
-                // Segment exists, update boundaries
+            this->moments.merge(other.moments);
+        }
+    };
+
+    // Replaces provisional labels of rows [rowBegin, rowEnd) with finalLabels,
+    // and adds their pixels to components[componentIndices[provisionalLabel]]
+    // Note: just like in flood fill, pixels on image edges are left out of stats
+    void gatherRowsStats(
+        cv::Mat_<int>& segmentedImg,
+        const int& rowBegin,
+        const int& rowEnd,
+        const std::vector<int32_t>& finalLabels,
+        const std::vector<int32_t>& componentIndices,
+        std::vector<ComponentStats>& components
+    )
+    {
+        const int rows = segmentedImg.rows;
+        const int cols = segmentedImg.cols;
+
+        for (int y = rowBegin; y < rowEnd; y++) {
+            int32_t* labelsRow = segmentedImg.ptr<int32_t>(y);
+            const bool isEdgeRow = (y == 0 || y == rows - 1);
+
+            for (int x = 0; x < cols; x++) {
+                const int32_t label = labelsRow[x];
+
+                if (label == 0) {
+                    continue;
+                }
+
+                labelsRow[x] = finalLabels[label];
+
+                if (isEdgeRow || x == 0 || x == cols - 1) {
+                    continue;
+                }
+
+                components[componentIndices[label]].addPixel(x, y);
+            }
+        }
+    }
+
+    // Fills "labels" with labels of components which have any pixels outside of image edges
+    void getSegmentLabels(std::vector<ComponentStats>& components, std::vector<int32_t>& labels)
+    {
+        labels.clear();
+
+        for (size_t label = 1; label < components.size(); label++) {
+            components[label].flushRow();
+
+            if (components[label].moments.getArea() == 0) {
+                continue;
+            }
+
+            labels.push_back(label);
+        }
+    }
 
-                const auto thisSegmentID = accumulator;
-                auto& thisSegment = segmentsBoundaries.at(thisSegmentID - 1);
+    structs::Segment createSegment(
+        const cv::Mat_<int>& segmentedImg,
+        const int32_t& label,
+        const ComponentStats& component
+    )
+    {
+        structs::Segment segment;
 
-                segmentsIDs.at<double>(y, x) = thisSegmentID;
-                thisSegment.updateBoundaries(x, y);
+        segment.xMin = component.xMin;
+        segment.xMax = component.xMax;
+        segment.yMin = component.yMin;
+        segment.yMax = component.yMax;
+
+        segment.updatePixels(
+            segmentedImg,
+            label,
+            component.moments.getTranslated(component.yMin, component.xMin)
+        );
+
+        return segment;
+    }
+
+    // Segments of given labels, in the same order, with features (and so classification)
+    // computed on threadPool's threads when given
+    // Note: each segment takes the same (constant) time, as features come from known moments,
+    //       and batches are picked up by threads as they go, so no thread waits on a few big ones
+    std::vector<structs::Segment> createSegments(
+        const cv::Mat_<int>& segmentedImg,
+        const std::vector<int32_t>& segmentLabels,
+        const std::vector<ComponentStats>& components,
+        ThreadPool* threadPool
+    )
+    {
+        std::vector<structs::Segment> segments(segmentLabels.size());
+
+        const uint64_t batchSize = 64;
+        const uint64_t batchesCount = (segmentLabels.size() + batchSize - 1) / batchSize;
+
+        const auto createBatch = [&](const uint64_t& batchIdx) -> void
+        {
+            const uint64_t end = std::min<uint64_t>(segmentLabels.size(), (batchIdx + 1) * batchSize);
+
+            for (uint64_t idx = batchIdx * batchSize; idx < end; idx++) {
+                const auto& label = segmentLabels[idx];
+
+                segments[idx] = createSegment(segmentedImg, label, components[label]);
+            }
+        };
+
+        if (threadPool == nullptr) {
+            for (uint64_t batchIdx = 0; batchIdx < batchesCount; batchIdx++) {
+                createBatch(batchIdx);
             }
+        } else {
+            threadPool->parallelFor(batchesCount, createBatch);
+        }
+
+        return segments;
+    }
+
+    // Label image to fill, the caller's one (reallocated only if its size differs) when given
+    cv::Mat_<int> createLabelsImg(const int& rows, const int& cols, cv::Mat_<int>* segmentedImgOutput)
+    {
+        if (segmentedImgOutput == nullptr) {
+            return cv::Mat_<int>(rows, cols);
         }
+
+        segmentedImgOutput->create(rows, cols);
+
+        return *segmentedImgOutput;
+    }
+
+    // Horizontal run of white pixels, [xBegin, xEnd)
+    struct Run
+    {
+        int32_t xBegin;
+        int32_t xEnd;
+        int32_t label;
+    };
+
+    // Horizontal strip of the image, labelled on its own
+    struct Strip
+    {
+        int rowBegin = 0;
+        int rowEnd = 0;
+
+        // Strip-local provisional labels, and their strip-local final labels
+        std::vector<int32_t> parents = { 0 };
+        std::vector<int32_t> localLabels;
+        int32_t localLabelsCount = 0;
+
+        // Where strip-local final labels start in the shared label sets
+        int32_t labelsOffset = 0;
+
+        // Global final labels of strip-local provisional labels
+        std::vector<int32_t> finalLabels;
+        std::vector<ComponentStats> components;
+    };
+
+    template<class Item>
+    inline uint64_t getCapacityBytes(const std::vector<Item>& items)
+    {
+        return items.capacity() * sizeof(Item);
+    }
+}
+
+struct segmentation::Workspace::Buffers
+{
+    // Used by all methods
+    std::vector<int32_t> parents;
+    std::vector<int32_t> finalLabels;
+    std::vector<ComponentStats> components;
+    std::vector<int32_t> segmentLabels;
+
+    // Used by getImageSegmentsScanMerge
+    std::vector<Run> runs;
+    std::vector<size_t> rowRunsBegin;
+
+    // Used by getImageSegmentsFloodFill
+    std::vector<std::pair<int, int>> floodStack;
+
+    // Used by getImageSegmentsUnionFindParallel
+    // Note: atomics can't be moved, so shared label sets are only ever reallocated as a whole
+    std::vector<Strip> strips;
+    std::unique_ptr<std::atomic<int32_t>[]> sharedParents;
+    size_t sharedParentsCapacity = 0;
+};
+
+segmentation::Workspace::Workspace()
+    : buffers(new Buffers())
+{
+}
+
+segmentation::Workspace::~Workspace() = default;
+
+segmentation::Workspace::Workspace(Workspace&&) = default;
+
+segmentation::Workspace&
+segmentation::Workspace::operator=(Workspace&&) = default;
+
+segmentation::Workspace::Buffers&
+segmentation::Workspace::getBuffers()
+{
+    return *(this->buffers);
+}
+
+const uint64_t
+segmentation::Workspace::getReservedBytes()
+const
+{
+    const auto& buffers = *(this->buffers);
+
+    uint64_t bytes = (
+        getCapacityBytes(buffers.parents) +
+        getCapacityBytes(buffers.finalLabels) +
+        getCapacityBytes(buffers.components) +
+        getCapacityBytes(buffers.segmentLabels) +
+        getCapacityBytes(buffers.runs) +
+        getCapacityBytes(buffers.rowRunsBegin) +
+        getCapacityBytes(buffers.floodStack) +
+        getCapacityBytes(buffers.strips) +
+        (buffers.sharedParentsCapacity * sizeof(std::atomic<int32_t>))
     );
 
-    // Merge touching segments
-    std::vector<std::reference_wrapper<structs::Segment>> segmentsRefs;
+    for (const auto& strip: buffers.strips) {
+        bytes += (
+            getCapacityBytes(strip.parents) +
+            getCapacityBytes(strip.localLabels) +
+            getCapacityBytes(strip.finalLabels) +
+            getCapacityBytes(strip.components)
+        );
+    }
+
+    return bytes;
+}
+
+const void
+segmentation::Workspace::release()
+{
+    this->buffers.reset(new Buffers());
+}
+
+namespace
+{
+    // Buffers of the caller's workspace, or of a temporary one (kept in localWorkspace) without it
+    segmentation::Workspace::Buffers& getWorkspaceBuffers(
+        segmentation::Workspace* workspace,
+        std::unique_ptr<segmentation::Workspace>& localWorkspace
+    )
+    {
+        if (workspace == nullptr) {
+            localWorkspace.reset(new segmentation::Workspace());
+            workspace = localWorkspace.get();
+        }
 
-    for (auto& segment: segmentsBoundaries) {
-        segmentsRefs.push_back(std::ref(segment));
+        return workspace->getBuffers();
     }
+}
+
+std::vector<structs::Segment>
+segmentation::getImageSegmentsScanMerge(
+    const cv::Mat& img,
+    const bool& useDiagonalDetection,
+    cv::Mat_<int>* segmentedImgOutput,
+    Workspace* workspace,
+    ThreadPool* threadPool
+)
+{
+    std::unique_ptr<Workspace> localWorkspace;
+    auto& buffers = getWorkspaceBuffers(workspace, localWorkspace);
+
+    const int rows = img.rows;
+    const int cols = img.cols;
+
+    // With diagonal detection, runs touch even if they only meet at corners
+    const int32_t touchDistance = (useDiagonalDetection ? 1 : 0);
+
+    auto& runs = buffers.runs;
+    auto& rowRunsBegin = buffers.rowRunsBegin;
+
+    runs.clear();
+    rowRunsBegin.assign(rows + 1, 0);
+
+    // Label "0" is the background
+    auto& parents = buffers.parents;
+
+    parents.assign(1, 0);
+
+    // Encode each row as runs, and label them against touching runs of the previous row
+    for (int y = 0; y < rows; y++) {
+        const uint8_t* row = img.ptr<uint8_t>(y);
+
+        rowRunsBegin[y] = runs.size();
+
+        for (int x = 0; x < cols; x++) {
+            if (row[x] != consts::colors::white) {
+                continue;
+            }
+
+            const int32_t xBegin = x;
+
+            while (x < cols && row[x] == consts::colors::white) {
+                x++;
+            }
+
+            runs.push_back({ xBegin, x, 0 });
+        }
+
+        const size_t prevRunsEnd = rowRunsBegin[y];
+        size_t prevRunIdx = (y > 0 ? rowRunsBegin[y - 1] : prevRunsEnd);
+
+        for (size_t runIdx = rowRunsBegin[y]; runIdx < runs.size(); runIdx++) {
+            auto& run = runs[runIdx];
+
+            // Skip previous row's runs which end before this one starts,
+            // they can't touch any further runs either
+            while (prevRunIdx < prevRunsEnd && runs[prevRunIdx].xEnd + touchDistance <= run.xBegin) {
+                prevRunIdx++;
+            }
+
+            for (size_t touchingIdx = prevRunIdx; touchingIdx < prevRunsEnd; touchingIdx++) {
+                const auto& touching = runs[touchingIdx];
 
-    for (uint64_t segmentIdx = 0; segmentIdx < segmentsRefs.size(); segmentIdx++) {
-        const auto& segmentRef = segmentsRefs.at(segmentIdx);
-        auto& segment = segmentRef.get();
-        const auto& touching = touchingSegments.at(segmentIdx + 1);
+                if (touching.xBegin >= run.xEnd + touchDistance) {
+                    break;
+                }
 
-        for (const auto& touchesIdx: touching) {
-            const auto& touched = segmentsRefs.at(touchesIdx - 1);
+                if (run.label == 0) {
+                    run.label = touching.label;
+                } else if (run.label != touching.label) {
+                    run.label = mergeLabels(parents, run.label, touching.label);
+                }
+            }
 
-            segment.merge(touched);
-            segmentsRefs.at(touchesIdx - 1) = segmentRef;
+            if (run.label == 0) {
+                run.label = createLabel(parents);
+            }
         }
     }
 
-    std::unordered_set<structs::Segment*> uniqSegments;
-    for (const auto& segment: segmentsRefs) {
-        structs::Segment* segmentPtr = &(segment.get());
+    rowRunsBegin[rows] = runs.size();
+
+    auto& finalLabels = buffers.finalLabels;
+    const int32_t finalLabelsCount = flattenLabels(parents, finalLabels);
 
-        uniqSegments.insert(segmentPtr);
+    for (auto& run: runs) {
+        run.label = finalLabels[run.label];
     }
 
-    std::vector<structs::Segment> segments;
-    for (const auto& segmentPtr: uniqSegments) {
-        segments.push_back((*segmentPtr));
+    // Gather stats run by run
+    // Note: just like in flood fill, pixels on image edges are left out of stats
+    auto& components = buffers.components;
+
+    components.assign(finalLabelsCount + 1, ComponentStats());
+
+    for (int y = 1; y < rows - 1; y++) {
+        for (size_t runIdx = rowRunsBegin[y]; runIdx < rowRunsBegin[y + 1]; runIdx++) {
+            const auto& run = runs[runIdx];
+
+            const int32_t xFirst = std::max(run.xBegin, 1);
+            const int32_t xLast = std::min(run.xEnd, cols - 1) - 1;
+
+            if (xFirst > xLast) {
+                continue;
+            }
+
+            components[run.label].addRun(xFirst, xLast, y);
+        }
+    }
+
+    // Segments view their pixels through a label image, draw it from runs
+    auto segmentedImg = createLabelsImg(rows, cols, segmentedImgOutput);
+
+    for (int y = 0; y < rows; y++) {
+        int32_t* labelsRow = segmentedImg.ptr<int32_t>(y);
+
+        std::fill(labelsRow, labelsRow + cols, 0);
+
+        for (size_t runIdx = rowRunsBegin[y]; runIdx < rowRunsBegin[y + 1]; runIdx++) {
+            const auto& run = runs[runIdx];
+
+            std::fill(labelsRow + run.xBegin, labelsRow + run.xEnd, run.label);
+        }
     }
 
-    // Note: does not update Segment's pixels
+    getSegmentLabels(components, buffers.segmentLabels);
+
+    const auto segments = createSegments(segmentedImg, buffers.segmentLabels, components, threadPool);
+
+    if (segmentedImgOutput != nullptr) {
+        *segmentedImgOutput = segmentedImg;
+    }
 
     return segments;
 }
 
 std::vector<structs::Segment>
-segmentation::getImageSegmentsFloodFill(const cv::Mat& img, const bool& diagDetection)
+segmentation::getImageSegmentsFloodFill(
+    const cv::Mat& img,
+    const bool& diagDetection,
+    cv::Mat_<int>* segmentedImgOutput,
+    Workspace* workspace
+)
 {
-    cv::Mat_<cv::Vec3i> segmentedImg = img.clone();
+    std::unique_ptr<Workspace> localWorkspace;
+    auto& buffers = getWorkspaceBuffers(workspace, localWorkspace);
+
+    auto segmentedImg = createLabelsImg(img.rows, img.cols, segmentedImgOutput);
+
+    matrixOps::mapEachPixel<uint8_t, int>(
+        img,
+        segmentedImg,
+        [](const uint8_t& thisPixel, int& resultPixel) -> void
+        {
+            resultPixel = thisPixel;
+        }
+    );
 
     int currentSegmentID = 1;
 
+    // Note: a single stack for all floods, always empty once a flood is done
+    auto& neighbours = buffers.floodStack;
+
+    neighbours.clear();
+
+    std::vector<structs::Segment> segments;
+
     matrixOps::forEachPixel(
         img,
         [&](const uint64_t& x, const uint64_t& y) -> void
         {
-            if (segmentedImg(y, x)[0] != consts::colors::white) {
+            if (segmentedImg(y, x) != consts::colors::white) {
                 return;
             }
 
-            std::stack<std::pair<int, int>> neighbours;
+            // Bounding box and moments are gathered while filling,
+            // just like in union-find, pixels on image edges are left out of them
+            ComponentStats component;
 
-            neighbours.push({ x, y });
+            neighbours.push_back({ x, y });
 
             // FloodFill
             while (!neighbours.empty()) {
-                int neighbourX = neighbours.top().first;
-                int neighbourY = neighbours.top().second;
+                int neighbourX = neighbours.back().first;
+                int neighbourY = neighbours.back().second;
 
-                neighbours.pop();
+                neighbours.pop_back();
+
+                // Pixels can be pushed more than once before they are reached
+                if (segmentedImg(neighbourY, neighbourX) != consts::colors::white) {
+                    continue;
+                }
 
-                segmentedImg(neighbourY,neighbourX)[0] = currentSegmentID;
+                segmentedImg(neighbourY,neighbourX) = currentSegmentID;
+
+                if (neighbourY > 0 && neighbourY < img.rows - 1 && neighbourX > 0 && neighbourX < img.cols - 1) {
+                    component.addUnorderedPixel(neighbourX, neighbourY);
+                }
 
                 for (int adjacentY = -1; adjacentY <= 1; ++adjacentY) {
                     for (int adjacentX = -1; adjacentX <= 1; ++adjacentX) {
@@ -200,11 +809,11 @@ segmentation::getImageSegmentsFloodFill(const cv::Mat& img, const bool& diagDete
                         if (neighbourX + adjacentX < 0 || neighbourX + adjacentX >= img.cols) {
                             continue;
                         }
-                        if (segmentedImg(neighbourY + adjacentY, neighbourX + adjacentX)[0] != consts::colors::white) {
+                        if (segmentedImg(neighbourY + adjacentY, neighbourX + adjacentX) != consts::colors::white) {
                             continue;
                         }
 
-                        neighbours.push({
+                        neighbours.push_back({
                             neighbourX + adjacentX,
                             neighbourY + adjacentY
                         });
@@ -212,6 +821,10 @@ segmentation::getImageSegmentsFloodFill(const cv::Mat& img, const bool& diagDete
                 }
             }
 
+            if (component.moments.getArea() > 0) {
+                segments.push_back(createSegment(segmentedImg, currentSegmentID, component));
+            }
+
             // Segmentation pixels can still hold WHITE (255) or BLACK (0) values
             // make sure we do not use those
             if ((currentSegmentID + 2) % 256 == 0) {
@@ -222,45 +835,220 @@ segmentation::getImageSegmentsFloodFill(const cv::Mat& img, const bool& diagDete
         }
     );
 
-    std::unordered_map<int, structs::Segment> segmentsMap;
+    if (segmentedImgOutput != nullptr) {
+        *segmentedImgOutput = segmentedImg;
+    }
 
-    matrixOps::forEachPixel(
-        img,
-        [&](const uint64_t& x, const uint64_t& y) -> void
+    return segments;
+}
+
+std::vector<structs::Segment>
+segmentation::getImageSegmentsUnionFind(
+    const cv::Mat& img,
+    const bool& diagDetection,
+    cv::Mat_<int>* segmentedImgOutput,
+    Workspace* workspace,
+    ThreadPool* threadPool
+)
+{
+    std::unique_ptr<Workspace> localWorkspace;
+    auto& buffers = getWorkspaceBuffers(workspace, localWorkspace);
+
+    auto segmentedImg = createLabelsImg(img.rows, img.cols, segmentedImgOutput);
+
+    // Label "0" is the background
+    auto& parents = buffers.parents;
+
+    parents.assign(1, 0);
+
+    labelRows(img, segmentedImg, 0, img.rows, parents, diagDetection);
+
+    auto& finalLabels = buffers.finalLabels;
+    const int32_t finalLabelsCount = flattenLabels(parents, finalLabels);
+
+    auto& components = buffers.components;
+
+    components.assign(finalLabelsCount + 1, ComponentStats());
+
+    gatherRowsStats(segmentedImg, 0, img.rows, finalLabels, finalLabels, components);
+
+    getSegmentLabels(components, buffers.segmentLabels);
+
+    const auto segments = createSegments(segmentedImg, buffers.segmentLabels, components, threadPool);
+
+    if (segmentedImgOutput != nullptr) {
+        *segmentedImgOutput = segmentedImg;
+    }
+
+    return segments;
+}
+
+std::vector<structs::Segment>
+segmentation::getImageSegmentsUnionFindParallel(
+    const cv::Mat& img,
+    ThreadPool& threadPool,
+    const bool& diagDetection,
+    cv::Mat_<int>* segmentedImgOutput,
+    Workspace* workspace
+)
+{
+    std::unique_ptr<Workspace> localWorkspace;
+    auto& buffers = getWorkspaceBuffers(workspace, localWorkspace);
+
+    const int rows = img.rows;
+    const int cols = img.cols;
+
+    auto segmentedImg = createLabelsImg(rows, cols, segmentedImgOutput);
+
+    const int stripsCount = std::max(1, std::min<int>(rows, threadPool.getThreadsCount()));
+    auto& strips = buffers.strips;
+
+    strips.resize(stripsCount);
+
+    for (int idx = 0; idx < stripsCount; idx++) {
+        auto& strip = strips[idx];
+
+        strip.rowBegin = ((int64_t) rows * idx) / stripsCount;
+        strip.rowEnd = ((int64_t) rows * (idx + 1)) / stripsCount;
+        strip.parents.assign(1, 0);
+        strip.localLabelsCount = 0;
+        strip.labelsOffset = 0;
+    }
+
+    // Label each strip on its own
+    threadPool.parallelFor(
+        stripsCount,
+        [&](const uint64_t& idx) -> void
+        {
+            auto& strip = strips[idx];
+
+            labelRows(img, segmentedImg, strip.rowBegin, strip.rowEnd, strip.parents, diagDetection);
+
+            strip.localLabelsCount = flattenLabels(strip.parents, strip.localLabels);
+        }
+    );
+
+    int32_t labelsCount = 0;
+
+    for (auto& strip: strips) {
+        strip.labelsOffset = labelsCount;
+        labelsCount += strip.localLabelsCount;
+    }
+
+    if (buffers.sharedParentsCapacity < (size_t) labelsCount + 1) {
+        buffers.sharedParentsCapacity = labelsCount + 1;
+        buffers.sharedParents.reset(new std::atomic<int32_t>[buffers.sharedParentsCapacity]);
+    }
+
+    auto sharedParents = buffers.sharedParents.get();
+
+    for (int32_t label = 0; label <= labelsCount; label++) {
+        sharedParents[label].store(label, std::memory_order_relaxed);
+    }
+
+    const auto getSharedLabel = [&](const Strip& strip, const int32_t& provisionalLabel) -> int32_t
+    {
+        return strip.labelsOffset + strip.localLabels[provisionalLabel];
+    };
+
+    // Merge labels touching across strip borders, each border on its own
+    threadPool.parallelFor(
+        stripsCount - 1,
+        [&](const uint64_t& idx) -> void
         {
-            if (x == 0 || x == img.cols - 1 || y == 0 || y == img.rows - 1) {
+            const auto& upperStrip = strips[idx];
+            const auto& lowerStrip = strips[idx + 1];
+
+            if (upperStrip.rowBegin == upperStrip.rowEnd || lowerStrip.rowBegin == lowerStrip.rowEnd) {
                 return;
             }
 
-            const auto& thisSegmentID = segmentedImg(y, x)[0];
+            const int32_t* labelsRow = segmentedImg.ptr<int32_t>(lowerStrip.rowBegin);
+            const int32_t* prevLabelsRow = segmentedImg.ptr<int32_t>(lowerStrip.rowBegin - 1);
 
-            if (thisSegmentID == consts::colors::black) {
-                return;
+            for (int x = 0; x < cols; x++) {
+                if (labelsRow[x] == 0) {
+                    continue;
+                }
+
+                const int32_t label = getSharedLabel(lowerStrip, labelsRow[x]);
+
+                for (int adjacentX = -1; adjacentX <= 1; adjacentX++) {
+                    if (adjacentX != 0 && !diagDetection) {
+                        continue;
+                    }
+                    if (x + adjacentX < 0 || x + adjacentX >= cols) {
+                        continue;
+                    }
+                    if (prevLabelsRow[x + adjacentX] == 0) {
+                        continue;
+                    }
+
+                    mergeSharedLabels(
+                        sharedParents,
+                        label,
+                        getSharedLabel(upperStrip, prevLabelsRow[x + adjacentX])
+                    );
+                }
             }
+        }
+    );
+
+    // Strips come in raster order, so final labels do too (same as in the single-threaded version)
+    auto& finalLabels = buffers.finalLabels;
+    int32_t finalLabelsCount = 0;
 
-            if (segmentsMap.count(thisSegmentID) == 0) {
-                structs::Segment seg;
+    finalLabels.assign(labelsCount + 1, 0);
 
-                seg.xMin = x;
-                seg.xMax = x;
-                seg.yMin = y;
-                seg.yMax = y;
+    for (int32_t label = 1; label <= labelsCount; label++) {
+        const int32_t parent = sharedParents[label].load(std::memory_order_relaxed);
+
+        if (parent == label) {
+            finalLabels[label] = ++finalLabelsCount;
+        } else {
+            finalLabels[label] = finalLabels[parent];
+        }
+    }
+
+    // Gather stats of each strip on its own, then merge them
+    threadPool.parallelFor(
+        stripsCount,
+        [&](const uint64_t& idx) -> void
+        {
+            auto& strip = strips[idx];
 
-                segmentsMap.insert({ thisSegmentID, seg });
+            strip.finalLabels.assign(strip.parents.size(), 0);
+
+            for (size_t label = 1; label < strip.parents.size(); label++) {
+                strip.finalLabels[label] = finalLabels[getSharedLabel(strip, label)];
             }
 
-            segmentsMap.at(thisSegmentID).updateBoundaries(x, y);
+            strip.components.assign(strip.localLabelsCount + 1, ComponentStats());
+
+            gatherRowsStats(segmentedImg, strip.rowBegin, strip.rowEnd, strip.finalLabels, strip.localLabels, strip.components);
+
+            for (auto& component: strip.components) {
+                component.flushRow();
+            }
         }
     );
 
-    for (auto& segment: segmentsMap) {
-        segment.second.updatePixels(segmentedImg, segment.first);
+    auto& components = buffers.components;
+
+    components.assign(finalLabelsCount + 1, ComponentStats());
+
+    for (const auto& strip: strips) {
+        for (int32_t label = 1; label <= strip.localLabelsCount; label++) {
+            components[finalLabels[strip.labelsOffset + label]].merge(strip.components[label]);
+        }
     }
 
-    std::vector<structs::Segment> segments;
+    getSegmentLabels(components, buffers.segmentLabels);
+
+    const auto segments = createSegments(segmentedImg, buffers.segmentLabels, components, &threadPool);
 
-    for (auto& segment: segmentsMap) {
-        segments.push_back(segment.second);
+    if (segmentedImgOutput != nullptr) {
+        *segmentedImgOutput = segmentedImg;
     }
 
     return segments;
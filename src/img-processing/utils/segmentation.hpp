@@ -1,22 +1,92 @@
 #ifndef POBR_IMGPROCESSING_UTILS_SEGMENTATION_HPP
 #define POBR_IMGPROCESSING_UTILS_SEGMENTATION_HPP
 
+#include <cstdint>
 #include <vector>
+#include <memory>
 #include <opencv2/core/core.hpp>
 
+#include "../../utils/thread-pool/ThreadPool.hpp"
 #include "../structs/Segment.hpp"
 
 namespace structs = pobr::imgProcessing::structs;
 
 namespace pobr::imgProcessing::utils::segmentation
 {
+    // Working memory of segmentation methods (label sets, per-label stats, flood fill stack, ...),
+    // which can be passed to them to be reused between calls, it only grows,
+    // up to what the largest image (with the most labels) needed so far
+    // Note: not thread-safe, use one per thread (a method working on multiple threads
+    //       keeps separate memory for each of its strips within it)
+    class Workspace
+    {
+    public:
+        struct Buffers;
+
+        Workspace();
+        ~Workspace();
+
+        Workspace(const Workspace&) = delete;
+        Workspace& operator=(const Workspace&) = delete;
+        Workspace(Workspace&&);
+        Workspace& operator=(Workspace&&);
+
+        Buffers& getBuffers();
+
+        // Memory held by the buffers (their high-water mark)
+        const uint64_t getReservedBytes() const;
+        const void release();
+
+    protected:
+        std::unique_ptr<Buffers> buffers;
+    };
+
+    // Note: each method can also output its label image (through segmentedImgOutput),
+    //       where pixels of a segment are equal to its "label", and background is 0,
+    //       it is then written into the given buffer, which is only reallocated if its size differs
+    //       (segments view their pixels through it, so reusing it invalidates their views)
+    // Note: with "workspace" given, methods keep their working memory in it instead
+    //       of allocating it on each call (see Workspace)
+    // Note: with "threadPool" given, segments' features (and classification) are computed
+    //       on its threads, in batches, with the same segments in the same order
+
+    // Run-length scanline segmentation, runs touching across rows are merged with union-find,
+    // stats are computed per run instead of per pixel
+    // Produces the same segments as getImageSegmentsFloodFill (in raster order of their first pixel)
     std::vector<structs::Segment> getImageSegmentsScanMerge(
         const cv::Mat& img,
-        const bool& useDiagonalDetection = true
+        const bool& useDiagonalDetection = true,
+        cv::Mat_<int>* segmentedImgOutput = nullptr,
+        Workspace* workspace = nullptr,
+        pobr::utils::ThreadPool* threadPool = nullptr
     );
+    // Stack-based flood fill, bounding boxes and moments are gathered while filling,
+    // segments come in raster order of their first pixel
     std::vector<structs::Segment> getImageSegmentsFloodFill(
         const cv::Mat& img,
-        const bool& diagDetection = false
+        const bool& diagDetection = false,
+        cv::Mat_<int>* segmentedImgOutput = nullptr,
+        Workspace* workspace = nullptr
+    );
+    // Two-pass connected-component labelling (union-find over provisional labels),
+    // bounding boxes and moments are gathered while resolving the labels.
+    // Produces the same segments as getImageSegmentsFloodFill, in raster order
+    // of their first pixel (on both passes, image edges only connect pixels)
+    std::vector<structs::Segment> getImageSegmentsUnionFind(
+        const cv::Mat& img,
+        const bool& diagDetection = false,
+        cv::Mat_<int>* segmentedImgOutput = nullptr,
+        Workspace* workspace = nullptr,
+        pobr::utils::ThreadPool* threadPool = nullptr
+    );
+    // Same as above, but labels horizontal strips of the image on separate threads
+    // and merges labels across strip borders, with the very same result
+    std::vector<structs::Segment> getImageSegmentsUnionFindParallel(
+        const cv::Mat& img,
+        pobr::utils::ThreadPool& threadPool,
+        const bool& diagDetection = false,
+        cv::Mat_<int>* segmentedImgOutput = nullptr,
+        Workspace* workspace = nullptr
     );
 }
 
@@ -1,15 +1,22 @@
 #include "App.hpp"
 
+#include <fstream>
+#include <iostream>
+#include <algorithm>
 #include <opencv2/highgui/highgui.hpp>
 
+#include "BatchProcessor.hpp"
+#include "StreamProcessor.hpp"
 #include "../utils/logger/Logger.hpp"
-#include "../utils/cmd-parser/CmdParser.hpp"
 #include "../img-processing/ImgProcessor.hpp"
 
 using Logger = pobr::utils::Logger;
 using CmdParser = pobr::utils::CmdParser;
 using ImgProcessor = pobr::imgProcessing::ImgProcessor;
+using Classifier = pobr::imgProcessing::structs::Classifier;
 
+using BatchProcessor = pobr::main::BatchProcessor;
+using StreamProcessor = pobr::main::StreamProcessor;
 using App = pobr::main::App;
 
 App::App(const std::vector<std::string>& arguments)
@@ -18,45 +25,222 @@ App::App(const std::vector<std::string>& arguments)
     {
         auto cmdParser = CmdParser(arguments);
 
-        auto const filepath = cmdParser.getFlagValue("file");
-        const bool showBinaryImg = cmdParser.hasFlag("binary");
+        if (cmdParser.hasFlag("model")) {
+            Classifier::setModel(Classifier::fromFile(cmdParser.getFlagValue("model")));
+        }
+        if (cmdParser.hasFlag("skip-checks")) {
+            auto model = Classifier::getModel();
+
+            model.setPrefilter(Classifier::skipChecks(model.getPrefilter(), cmdParser.getFlagValue("skip-checks")));
+
+            Classifier::setModel(model);
+        }
 
-        if (filepath.length() < 1)
-        {
-            Logger::error("No input file specified");
+        if (cmdParser.hasFlag("dir") || cmdParser.hasFlag("list")) {
+            this->runBatch(cmdParser);
+        } else if (cmdParser.hasFlag("video")) {
+            this->runStream(cmdParser);
+        } else {
+            this->runSingle(cmdParser);
         }
+    }
+    catch(Logger::Exception &e)
+    {
+        Logger::error("Terminating...", true);
+    }
+}
 
-        auto imgProcessor = ImgProcessor();
+const void
+App::runSingle(const CmdParser& cmdParser)
+{
+    auto const filepath = cmdParser.getFlagValue("file");
+    const bool showBinaryImg = cmdParser.hasFlag("binary");
 
-        imgProcessor.loadImg(filepath);
+    if (filepath.length() < 1)
+    {
+        Logger::error("No input file specified");
+    }
 
-        auto letterSegments = imgProcessor.process();
+    auto imgProcessor = ImgProcessor();
 
-        if (showBinaryImg) {
-            auto img = imgProcessor.drawSegmentsBBoxes(
-                imgProcessor.getBinarizedImg(),
-                letterSegments,
-                { 0, 0, 255 },
-                3
-            );
+    if (cmdParser.hasFlag("threads")) {
+        imgProcessor.setThreadsCount(cmdParser.getPositiveIntegerFlagValue("threads"));
+    }
+    if (cmdParser.hasFlag("prescan")) {
+        imgProcessor.setScanMethod(ImgProcessor::ScanMethod::CoarseToFine);
+        imgProcessor.setPreScanFactor(cmdParser.getPositiveIntegerFlagValue("prescan"));
+    }
 
-            cv::imshow(filepath, img);
-        } else {
-            auto img = imgProcessor.drawSegmentsBBoxes(
-                imgProcessor.getImg(),
-                letterSegments,
-                { 0, 0, 0 },
-                3
-            );
-
-            cv::imshow(filepath, img);
+    imgProcessor.loadImg(filepath);
+
+    auto letterSegments = imgProcessor.process();
+
+    if (showBinaryImg) {
+        auto img = ImgProcessor::drawSegmentsBBoxes(
+            imgProcessor.getBinarizedImg(),
+            letterSegments,
+            { 0, 0, 255 },
+            3
+        );
+
+        cv::imshow(filepath, img);
+    } else {
+        auto img = ImgProcessor::drawSegmentsBBoxes(
+            imgProcessor.getImg(),
+            letterSegments,
+            { 0, 0, 0 },
+            3
+        );
+
+        cv::imshow(filepath, img);
+    }
+
+    cv::waitKey(-1);
+}
+
+const void
+App::runBatch(const CmdParser& cmdParser)
+{
+    const auto imgPaths = (
+        cmdParser.hasFlag("dir") ?
+        App::listDirImages(cmdParser.getFlagValue("dir")) :
+        App::listFileImages(cmdParser.getFlagValue("list"))
+    );
+
+    if (imgPaths.empty()) {
+        Logger::error("No input images found");
+    }
+
+    std::ofstream outputFile;
+    auto& output = App::openOutput(cmdParser, outputFile);
+
+    auto batchProcessor = BatchProcessor();
+
+    if (cmdParser.hasFlag("decoders")) {
+        batchProcessor.setDecodersCount(cmdParser.getPositiveIntegerFlagValue("decoders"));
+    }
+    if (cmdParser.hasFlag("workers")) {
+        batchProcessor.setWorkersCount(cmdParser.getPositiveIntegerFlagValue("workers"));
+    }
+    if (cmdParser.hasFlag("writers")) {
+        batchProcessor.setWritersCount(cmdParser.getPositiveIntegerFlagValue("writers"));
+    }
+    if (cmdParser.hasFlag("queue-depth")) {
+        batchProcessor.setQueueDepth(cmdParser.getPositiveIntegerFlagValue("queue-depth"));
+    }
+    if (cmdParser.hasFlag("prescan")) {
+        batchProcessor.setPreScanFactor(cmdParser.getPositiveIntegerFlagValue("prescan"));
+    }
+    if (cmdParser.hasFlag("annotated")) {
+        batchProcessor.setAnnotatedDirPath(cmdParser.getFlagValue("annotated"));
+    }
+
+    batchProcessor.run(imgPaths, output);
+}
+
+const void
+App::runStream(const CmdParser& cmdParser)
+{
+    const auto source = cmdParser.getFlagValue("video");
+
+    if (source.empty()) {
+        Logger::error("No video source specified");
+    }
+
+    std::ofstream outputFile;
+    auto& output = App::openOutput(cmdParser, outputFile);
+
+    auto streamProcessor = StreamProcessor();
+
+    if (cmdParser.hasFlag("threads")) {
+        streamProcessor.setThreadsCount(cmdParser.getPositiveIntegerFlagValue("threads"));
+    }
+    if (cmdParser.hasFlag("prescan")) {
+        streamProcessor.setPreScanFactor(cmdParser.getPositiveIntegerFlagValue("prescan"));
+    }
+    if (cmdParser.hasFlag("track-margin")) {
+        streamProcessor.setTrackingMargin(cmdParser.getPositiveIntegerFlagValue("track-margin"));
+    }
+    if (cmdParser.hasFlag("rescan")) {
+        streamProcessor.setFullScanInterval(cmdParser.getPositiveIntegerFlagValue("rescan"));
+    }
+
+    streamProcessor.run(source, output);
+}
+
+std::ostream&
+App::openOutput(const CmdParser& cmdParser, std::ofstream& outputFile)
+{
+    const auto outputPath = cmdParser.getFlagValue("output");
+
+    if (outputPath.empty()) {
+        return std::cout;
+    }
+
+    outputFile.open(outputPath);
+
+    if (!outputFile) {
+        Logger::error("Could not open \"" + outputPath + "\" for writing");
+    }
+
+    return outputFile;
+}
+
+const std::vector<std::string>
+App::listDirImages(const std::string& dirPath)
+{
+    const std::vector<std::string> extensions = { ".jpg", ".jpeg", ".png", ".bmp", ".tif", ".tiff" };
+
+    std::vector<std::string> paths;
+    std::vector<std::string> imgPaths;
+
+    cv::glob(dirPath + "/*", paths);
+
+    for (const auto& path: paths) {
+        const auto extensionPos = path.rfind('.');
+
+        if (extensionPos == std::string::npos) {
+            continue;
         }
 
-        cv::waitKey(-1);
+        auto extension = path.substr(extensionPos);
+
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
 
+        if (std::find(extensions.begin(), extensions.end(), extension) == extensions.end()) {
+            continue;
+        }
+
+        imgPaths.push_back(path);
     }
-    catch(Logger::Exception &e)
-    {
-        Logger::error("Terminating...", true);
+
+    std::sort(imgPaths.begin(), imgPaths.end());
+
+    return imgPaths;
+}
+
+const std::vector<std::string>
+App::listFileImages(const std::string& listPath)
+{
+    std::ifstream listFile(listPath);
+
+    if (!listFile) {
+        Logger::error("Could not open \"" + listPath + "\"");
+    }
+
+    std::vector<std::string> imgPaths;
+    std::string line;
+
+    while (std::getline(listFile, line)) {
+        // Skip empty lines and comments, trim trailing whitespace (incl. "\r")
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+
+        imgPaths.push_back(line);
     }
+
+    return imgPaths;
 }
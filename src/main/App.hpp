@@ -3,14 +3,46 @@
 
 #include <vector>
 #include <string>
+#include <ostream>
+#include <fstream>
+
+#include "../utils/cmd-parser/CmdParser.hpp"
 
 namespace pobr::main
 {
+    // Note: "--prescan" enables coarse-to-fine scans, with a pre-scan downscaled "factor" times
+    // Note: "--model=<path>" (in every mode) replaces the built-in "TESCO" classifier model
+    //       with one loaded from a file (see models/tesco.txt)
+    // Note: "--skip-checks=<checks>" (in every mode) turns off some of the cheaper checks
+    //       preceding classification, eg. "--skip-checks=aspect-ratio,hu1" (see Classifier::skipChecks)
+    // Modes:
+    //   --file=<path> [--binary] [--threads=<N>] [--prescan=<factor>]
+    //     shows detections on a single image
+    //   --dir=<path> | --list=<path> [--output=<path>] [--annotated=<dir>]
+    //   [--decoders=<N>] [--workers=<N>] [--writers=<N>] [--queue-depth=<N>] [--prescan=<factor>]
+    //     headless batch mode, processes every image of a directory (or listed in a file,
+    //     one path per line) and writes detections as JSON lines, in input order
+    //   --video=<path> [--output=<path>] [--threads=<N>] [--prescan=<factor>]
+    //   [--track-margin=<pixels>] [--rescan=<N>]
+    //     headless stream mode, processes frames of a video file (or an image sequence
+    //     like "frames/%04d.jpg") and writes detections of each frame as JSON lines,
+    //     when tracking, only margins around previous detections are processed (see StreamProcessor)
     class App
     {
     public:
         App() = delete;
         explicit App(const std::vector<std::string>& arguments);
+
+    protected:
+        const void runSingle(const pobr::utils::CmdParser& cmdParser);
+        const void runBatch(const pobr::utils::CmdParser& cmdParser);
+        const void runStream(const pobr::utils::CmdParser& cmdParser);
+
+        // Standard output, unless "--output" is given
+        static std::ostream& openOutput(const pobr::utils::CmdParser& cmdParser, std::ofstream& outputFile);
+
+        static const std::vector<std::string> listDirImages(const std::string& dirPath);
+        static const std::vector<std::string> listFileImages(const std::string& listPath);
     };
 }
 
@@ -0,0 +1,386 @@
+#include "BatchProcessor.hpp"
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <exception>
+#include <algorithm>
+#include <opencv2/highgui/highgui.hpp>
+
+#include "../utils/json/json.hpp"
+#include "../utils/logger/Logger.hpp"
+#include "../utils/performance-timer/PerformanceTimer.hpp"
+#include "../utils/bounded-queue/BoundedQueue.hpp"
+#include "../img-processing/ImgProcessor.hpp"
+
+namespace json = pobr::utils::json;
+
+using Logger = pobr::utils::Logger;
+using PerformanceTimer = pobr::utils::PerformanceTimer;
+using ImgProcessor = pobr::imgProcessing::ImgProcessor;
+
+using BatchProcessor = pobr::main::BatchProcessor;
+
+namespace
+{
+    struct DecodedImg
+    {
+        uint64_t idx = 0;
+        cv::Mat img;
+    };
+
+    struct ProcessedImg
+    {
+        uint64_t idx = 0;
+        cv::Mat img;
+        std::vector<structs::Segment> detections;
+        std::string error;
+    };
+
+    // Nanoseconds spent in each stage, summed over its threads
+    struct StagesTimes
+    {
+        std::atomic<uint64_t> decoding { 0 };
+        std::atomic<uint64_t> processing { 0 };
+        std::atomic<uint64_t> writing { 0 };
+    };
+
+    const std::string
+    formatResult(const std::string& imgPath, const ProcessedImg& processedImg)
+    {
+        std::string result = "{\"file\": \"" + json::escape(imgPath) + "\", ";
+
+        if (!processedImg.error.empty()) {
+            return result + "\"error\": \"" + json::escape(processedImg.error) + "\"}";
+        }
+
+        result += "\"detections\": [";
+
+        for (size_t idx = 0; idx < processedImg.detections.size(); idx++) {
+            const auto& segment = processedImg.detections[idx];
+
+            result += (idx > 0 ? ", " : "");
+            result += "[" +
+                std::to_string(segment.xMin) + ", " +
+                std::to_string(segment.yMin) + ", " +
+                std::to_string(segment.xMax) + ", " +
+                std::to_string(segment.yMax) +
+            "]";
+        }
+
+        return result + "]}";
+    }
+
+    const std::string
+    getFileName(const std::string& path)
+    {
+        const auto separatorPos = path.find_last_of("/\\");
+
+        return (separatorPos == std::string::npos ? path : path.substr(separatorPos + 1));
+    }
+
+    template<class Operation>
+    const void
+    runMeasured(std::atomic<uint64_t>& totalNS, Operation&& operation)
+    {
+        PerformanceTimer timer;
+
+        timer.start();
+        operation();
+        timer.stop();
+
+        totalNS += timer.getDurationNS();
+    }
+
+    // Starts "count" threads running "operation", the last one to finish calls "onDone"
+    template<class Operation, class OnDone>
+    const void
+    startStage(
+        std::vector<std::thread>& threads,
+        const unsigned int& count,
+        std::atomic<unsigned int>& runningCount,
+        Operation operation,
+        OnDone onDone
+    )
+    {
+        runningCount = count;
+
+        for (unsigned int idx = 0; idx < count; idx++) {
+            threads.emplace_back([&runningCount, operation, onDone]() {
+                operation();
+
+                if (runningCount.fetch_sub(1) == 1) {
+                    onDone();
+                }
+            });
+        }
+    }
+}
+
+const void
+BatchProcessor::setDecodersCount(const unsigned int& decodersCount)
+{
+    this->decodersCount = decodersCount;
+}
+
+const void
+BatchProcessor::setWorkersCount(const unsigned int& workersCount)
+{
+    this->workersCount = workersCount;
+}
+
+const void
+BatchProcessor::setWritersCount(const unsigned int& writersCount)
+{
+    this->writersCount = writersCount;
+}
+
+const void
+BatchProcessor::setQueueDepth(const unsigned int& queueDepth)
+{
+    this->queueDepth = queueDepth;
+}
+
+const void
+BatchProcessor::setPreScanFactor(const unsigned int& preScanFactor)
+{
+    this->preScanFactor = preScanFactor;
+}
+
+const void
+BatchProcessor::setAnnotatedDirPath(const std::string& annotatedDirPath)
+{
+    this->annotatedDirPath = annotatedDirPath;
+}
+
+const unsigned int
+BatchProcessor::resolveThreadsCount(const unsigned int& threadsCount)
+{
+    if (threadsCount > 0) {
+        return threadsCount;
+    }
+
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+const void
+BatchProcessor::run(const std::vector<std::string>& imgPaths, std::ostream& output)
+const
+{
+    const auto decodersCount = BatchProcessor::resolveThreadsCount(this->decodersCount);
+    const auto workersCount = BatchProcessor::resolveThreadsCount(this->workersCount);
+    const auto writersCount = BatchProcessor::resolveThreadsCount(this->writersCount);
+    const auto queueDepth = (this->queueDepth > 0 ? this->queueDepth : (2 * workersCount));
+
+    const bool isAnnotating = !this->annotatedDirPath.empty();
+
+    pobr::utils::BoundedQueue<DecodedImg> decodedQueue(queueDepth);
+    pobr::utils::BoundedQueue<ProcessedImg> processedQueue(queueDepth);
+
+    StagesTimes stagesTimes;
+    std::vector<std::thread> threads;
+
+    PerformanceTimer timer;
+
+    timer.start();
+
+    // Decoding
+    std::atomic<uint64_t> nextImgIdx { 0 };
+    std::atomic<unsigned int> runningDecodersCount { 0 };
+
+    startStage(
+        threads,
+        decodersCount,
+        runningDecodersCount,
+        [&]() -> void
+        {
+            uint64_t imgIdx;
+
+            while ((imgIdx = nextImgIdx.fetch_add(1)) < imgPaths.size()) {
+                DecodedImg decodedImg;
+
+                decodedImg.idx = imgIdx;
+
+                runMeasured(stagesTimes.decoding, [&]() {
+                    decodedImg.img = cv::imread(imgPaths[imgIdx]);
+                });
+
+                decodedQueue.push(std::move(decodedImg));
+            }
+        },
+        [&]() -> void
+        {
+            decodedQueue.close();
+        }
+    );
+
+    // Detection
+    std::atomic<unsigned int> runningWorkersCount { 0 };
+    // Scratch memory of all workers' ImgProcessors, summed once they are done
+    std::atomic<uint64_t> scratchBytes { 0 };
+
+    startStage(
+        threads,
+        workersCount,
+        runningWorkersCount,
+        [&]() -> void
+        {
+            // Note: images are spread over workers, so each ImgProcessor gets a single thread
+            auto imgProcessor = ImgProcessor();
+
+            imgProcessor.setThreadsCount(1);
+
+            if (this->preScanFactor > 0) {
+                imgProcessor.setScanMethod(ImgProcessor::ScanMethod::CoarseToFine);
+                imgProcessor.setPreScanFactor(this->preScanFactor);
+            }
+
+            DecodedImg decodedImg;
+
+            while (decodedQueue.pop(decodedImg)) {
+                ProcessedImg processedImg;
+
+                processedImg.idx = decodedImg.idx;
+
+                runMeasured(stagesTimes.processing, [&]() {
+                    if (decodedImg.img.empty()) {
+                        processedImg.error = "Could not properly load image";
+
+                        return;
+                    }
+
+                    try
+                    {
+                        imgProcessor.setImg(decodedImg.img);
+
+                        processedImg.detections = imgProcessor.process(false);
+
+                        // Note: detections' label views point into this worker's scratch memory,
+                        //       which the next image overwrites while writers may still be
+                        //       reading them, so they leave the worker with copies of their own
+                        for (auto& detection: processedImg.detections) {
+                            detection.detachLabelsView();
+                        }
+                    }
+                    catch(std::exception &e)
+                    {
+                        processedImg.error = e.what();
+                    }
+                });
+
+                if (isAnnotating) {
+                    processedImg.img = std::move(decodedImg.img);
+                }
+
+                decodedImg = DecodedImg();
+
+                processedQueue.push(std::move(processedImg));
+            }
+
+            scratchBytes += imgProcessor.getScratchBytes();
+        },
+        [&]() -> void
+        {
+            processedQueue.close();
+        }
+    );
+
+    // Drawing, encoding and writing
+    // Note: results are written in input order, as soon as all previous ones are done
+    std::mutex outputMutex;
+    std::map<uint64_t, std::string> pendingResults;
+    uint64_t nextOutputIdx = 0;
+    std::atomic<unsigned int> runningWritersCount { 0 };
+
+    startStage(
+        threads,
+        writersCount,
+        runningWritersCount,
+        [&]() -> void
+        {
+            ProcessedImg processedImg;
+
+            while (processedQueue.pop(processedImg)) {
+                const auto& imgPath = imgPaths[processedImg.idx];
+
+                runMeasured(stagesTimes.writing, [&]() {
+                    if (isAnnotating && processedImg.error.empty()) {
+                        const auto annotatedImg = ImgProcessor::drawSegmentsBBoxes(
+                            processedImg.img,
+                            processedImg.detections,
+                            { 0, 0, 0 },
+                            3
+                        );
+
+                        try
+                        {
+                            cv::imwrite(this->annotatedDirPath + "/" + getFileName(imgPath), annotatedImg);
+                        }
+                        catch(std::exception &e)
+                        {
+                            processedImg.error = e.what();
+                        }
+                    }
+
+                    auto result = formatResult(imgPath, processedImg);
+
+                    std::lock_guard<std::mutex> lock(outputMutex);
+
+                    pendingResults.emplace(processedImg.idx, std::move(result));
+
+                    while (!pendingResults.empty() && pendingResults.begin()->first == nextOutputIdx) {
+                        output << pendingResults.begin()->second << "\n";
+
+                        pendingResults.erase(pendingResults.begin());
+                        nextOutputIdx++;
+                    }
+                });
+
+                processedImg = ProcessedImg();
+            }
+        },
+        [&]() -> void
+        {
+            output.flush();
+        }
+    );
+
+    for (auto& thread: threads) {
+        thread.join();
+    }
+
+    timer.stop();
+
+    const double durationS = timer.getDurationNS() / 1000000000;
+
+    Logger::notice(
+        std::string("Processed ") +
+        std::to_string(imgPaths.size()) +
+        std::string(" images in ") +
+        std::to_string(durationS) +
+        std::string("s (") +
+        std::to_string(imgPaths.size() / durationS) +
+        std::string(" images/s)")
+    );
+    Logger::notice(
+        std::string("Threads (decoding / detection / writing): ") +
+        std::to_string(decodersCount) + " / " +
+        std::to_string(workersCount) + " / " +
+        std::to_string(writersCount) +
+        std::string(", queue depth: ") +
+        std::to_string(queueDepth)
+    );
+    Logger::notice(
+        std::string("Time spent in stages (decoding / detection / writing): ") +
+        std::to_string(stagesTimes.decoding / 1000000000.0) + "s / " +
+        std::to_string(stagesTimes.processing / 1000000000.0) + "s / " +
+        std::to_string(stagesTimes.writing / 1000000000.0) + "s"
+    );
+    Logger::notice(
+        std::string("Scratch memory of detection workers: ") +
+        std::to_string(scratchBytes / (1024 * 1024)) +
+        std::string("MiB")
+    );
+}
@@ -0,0 +1,44 @@
+#ifndef POBR_MAIN_BATCHPROCESSOR_HPP
+#define POBR_MAIN_BATCHPROCESSOR_HPP
+
+#include <vector>
+#include <string>
+#include <ostream>
+
+namespace pobr::main
+{
+    // Three-stage pipeline, connected by bounded queues:
+    //   decoding (I/O threads) -> detection (compute threads, one ImgProcessor each)
+    //   -> drawing, encoding and writing results (output threads)
+    // so decoding of the next images overlaps with processing of the current ones,
+    // while no more than a few images per thread are kept in memory
+    class BatchProcessor
+    {
+    public:
+        // "0" means one thread per CPU core
+        const void setDecodersCount(const unsigned int& decodersCount);
+        const void setWorkersCount(const unsigned int& workersCount);
+        const void setWritersCount(const unsigned int& writersCount);
+        // Capacity of each queue between stages, "0" means two images per worker
+        const void setQueueDepth(const unsigned int& queueDepth);
+        // Downscaling factor of coarse-to-fine scans, "0" means full scans
+        const void setPreScanFactor(const unsigned int& preScanFactor);
+        // If set, images with detections drawn are saved there, under their original file names
+        const void setAnnotatedDirPath(const std::string& annotatedDirPath);
+
+        // Writes one JSON line per image to "output", in input order
+        const void run(const std::vector<std::string>& imgPaths, std::ostream& output) const;
+
+    protected:
+        unsigned int decodersCount = 1;
+        unsigned int workersCount = 0;
+        unsigned int writersCount = 1;
+        unsigned int queueDepth = 0;
+        unsigned int preScanFactor = 0;
+        std::string annotatedDirPath;
+
+        static const unsigned int resolveThreadsCount(const unsigned int& threadsCount);
+    };
+}
+
+#endif
@@ -0,0 +1,303 @@
+#include "StreamProcessor.hpp"
+
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <sstream>
+#include <iomanip>
+#include <exception>
+#include <algorithm>
+#include <opencv2/videoio/videoio.hpp>
+
+#include "../utils/json/json.hpp"
+#include "../utils/logger/Logger.hpp"
+#include "../utils/performance-timer/PerformanceTimer.hpp"
+#include "../utils/bounded-queue/BoundedQueue.hpp"
+#include "../img-processing/ImgProcessor.hpp"
+#include "../img-processing/utils/detection.hpp"
+
+namespace json = pobr::utils::json;
+namespace detection = pobr::imgProcessing::utils::detection;
+
+using Logger = pobr::utils::Logger;
+using PerformanceTimer = pobr::utils::PerformanceTimer;
+using ImgProcessor = pobr::imgProcessing::ImgProcessor;
+
+using StreamProcessor = pobr::main::StreamProcessor;
+
+namespace
+{
+    // Frames decoded ahead of the one being processed, each with its own (recycled) buffer
+    const unsigned int framesInFlight = 2;
+
+    struct Frame
+    {
+        uint64_t idx = 0;
+        cv::Mat img;
+        double decodingNS = 0;
+    };
+
+    const std::string
+    formatResult(
+        const uint64_t& frameIdx,
+        const bool& isFullScan,
+        const double& latencyNS,
+        const std::vector<structs::Segment>& detections,
+        const std::string& error
+    )
+    {
+        std::stringstream result;
+
+        result << std::fixed << std::setprecision(3);
+        result << "{\"frame\": " << frameIdx << ", ";
+        result << "\"scan\": \"" << (isFullScan ? "full" : "tracked") << "\", ";
+        result << "\"latencyMs\": " << (latencyNS / 1000000) << ", ";
+
+        if (!error.empty()) {
+            result << "\"error\": \"" << json::escape(error) << "\"}";
+
+            return result.str();
+        }
+
+        result << "\"detections\": [";
+
+        for (size_t idx = 0; idx < detections.size(); idx++) {
+            const auto& segment = detections[idx];
+
+            result << (idx > 0 ? ", " : "");
+            result << "[" <<
+                segment.xMin << ", " <<
+                segment.yMin << ", " <<
+                segment.xMax << ", " <<
+                segment.yMax <<
+            "]";
+        }
+
+        result << "]}";
+
+        return result.str();
+    }
+
+    const double
+    getPercentile(const std::vector<double>& sortedValues, const double& percentile)
+    {
+        if (sortedValues.empty()) {
+            return 0;
+        }
+
+        const size_t idx = std::min(
+            sortedValues.size() - 1,
+            (size_t) (percentile * (sortedValues.size() - 1) + 0.5)
+        );
+
+        return sortedValues[idx];
+    }
+}
+
+const void
+StreamProcessor::setThreadsCount(const unsigned int& threadsCount)
+{
+    this->threadsCount = threadsCount;
+}
+
+const void
+StreamProcessor::setPreScanFactor(const unsigned int& preScanFactor)
+{
+    this->preScanFactor = preScanFactor;
+}
+
+const void
+StreamProcessor::setTrackingMargin(const unsigned int& trackingMargin)
+{
+    this->trackingMargin = trackingMargin;
+}
+
+const void
+StreamProcessor::setFullScanInterval(const unsigned int& fullScanInterval)
+{
+    this->fullScanInterval = std::max(1u, fullScanInterval);
+}
+
+const void
+StreamProcessor::run(const std::string& source, std::ostream& output)
+const
+{
+    cv::VideoCapture capture(source);
+
+    if (!capture.isOpened()) {
+        Logger::error("Could not open video source \"" + source + "\"");
+    }
+
+    auto imgProcessor = ImgProcessor();
+
+    imgProcessor.setThreadsCount(this->threadsCount);
+
+    if (this->preScanFactor > 0) {
+        imgProcessor.setScanMethod(ImgProcessor::ScanMethod::CoarseToFine);
+        imgProcessor.setPreScanFactor(this->preScanFactor);
+    }
+
+    // Empty buffers go to the decoder, decoded ones come back and get recycled once processed
+    pobr::utils::BoundedQueue<Frame> freeFrames(framesInFlight);
+    pobr::utils::BoundedQueue<Frame> decodedFrames(framesInFlight);
+
+    for (unsigned int idx = 0; idx < framesInFlight; idx++) {
+        freeFrames.push(Frame());
+    }
+
+    PerformanceTimer timer;
+
+    timer.start();
+
+    std::thread decoder([&]() -> void
+    {
+        Frame frame;
+        uint64_t frameIdx = 0;
+
+        while (freeFrames.pop(frame)) {
+            PerformanceTimer decodingTimer;
+
+            decodingTimer.start();
+
+            // Note: reads into frame's buffer, only reallocated if the resolution changes
+            if (!capture.read(frame.img) || frame.img.empty()) {
+                break;
+            }
+
+            decodingTimer.stop();
+
+            frame.idx = frameIdx++;
+            frame.decodingNS = decodingTimer.getDurationNS();
+
+            decodedFrames.push(std::move(frame));
+        }
+
+        decodedFrames.close();
+    });
+
+    std::vector<double> latenciesNS;
+    double decodingNS = 0;
+    uint64_t fullScansCount = 0;
+
+    std::vector<structs::Segment> detections;
+    uint64_t framesSinceFullScan = 0;
+
+    Frame frame;
+
+    while (decodedFrames.pop(frame)) {
+        const auto& img = frame.img;
+
+        std::vector<cv::Rect> regions;
+
+        if (this->trackingMargin > 0) {
+            const int margin = this->trackingMargin;
+
+            for (const auto& segment: detections) {
+                regions.push_back(
+                    cv::Rect(
+                        (int) segment.xMin - margin,
+                        (int) segment.yMin - margin,
+                        segment.getWidth() + (2 * margin),
+                        segment.getHeight() + (2 * margin)
+                    ) & cv::Rect(0, 0, img.cols, img.rows)
+                );
+            }
+
+            regions = detection::mergeRegions(regions);
+        }
+
+        uint64_t regionsArea = 0;
+
+        for (const auto& region: regions) {
+            regionsArea += region.area();
+        }
+
+        // Note: nothing to track (or tracking would not pay off) means a full scan as well
+        const bool isFullScan = (
+            regions.empty() ||
+            framesSinceFullScan + 1 >= this->fullScanInterval ||
+            regionsArea > (img.total() / 2)
+        );
+
+        PerformanceTimer latencyTimer;
+        std::string error;
+
+        latencyTimer.start();
+
+        try
+        {
+            imgProcessor.setImg(img);
+
+            detections = (
+                isFullScan ?
+                imgProcessor.process(false) :
+                imgProcessor.process(regions, false)
+            );
+        }
+        catch(std::exception &e)
+        {
+            detections.clear();
+            error = e.what();
+        }
+
+        latencyTimer.stop();
+
+        framesSinceFullScan = (isFullScan ? 0 : framesSinceFullScan + 1);
+        fullScansCount += (isFullScan ? 1 : 0);
+
+        latenciesNS.push_back(latencyTimer.getDurationNS());
+        decodingNS += frame.decodingNS;
+
+        output << formatResult(frame.idx, isFullScan, latenciesNS.back(), detections, error) << "\n";
+
+        freeFrames.push(std::move(frame));
+    }
+
+    freeFrames.close();
+    decoder.join();
+
+    timer.stop();
+
+    output.flush();
+
+    const double durationS = timer.getDurationNS() / 1000000000;
+    const uint64_t framesCount = latenciesNS.size();
+
+    if (framesCount == 0) {
+        Logger::warning("No frames could be read from \"" + source + "\"");
+
+        return;
+    }
+
+    double latenciesSumNS = 0;
+
+    for (const auto& latencyNS: latenciesNS) {
+        latenciesSumNS += latencyNS;
+    }
+
+    std::sort(latenciesNS.begin(), latenciesNS.end());
+
+    Logger::notice(
+        std::string("Processed ") +
+        std::to_string(framesCount) +
+        std::string(" frames in ") +
+        std::to_string(durationS) +
+        std::string("s (") +
+        std::to_string(framesCount / durationS) +
+        std::string(" FPS sustained)")
+    );
+    Logger::notice(
+        std::string("Frame latency (mean / p50 / p95 / max): ") +
+        std::to_string(latenciesSumNS / framesCount / 1000000) + "ms / " +
+        std::to_string(getPercentile(latenciesNS, 0.5) / 1000000) + "ms / " +
+        std::to_string(getPercentile(latenciesNS, 0.95) / 1000000) + "ms / " +
+        std::to_string(latenciesNS.back() / 1000000) + "ms"
+    );
+    Logger::notice(
+        std::string("Scans (full / tracked): ") +
+        std::to_string(fullScansCount) + " / " +
+        std::to_string(framesCount - fullScansCount) +
+        std::string(", time spent decoding: ") +
+        std::to_string(decodingNS / 1000000000) + "s"
+    );
+}
@@ -0,0 +1,37 @@
+#ifndef POBR_MAIN_STREAMPROCESSOR_HPP
+#define POBR_MAIN_STREAMPROCESSOR_HPP
+
+#include <string>
+#include <ostream>
+
+namespace pobr::main
+{
+    // Detection on consecutive frames of a video file (or a numbered image sequence,
+    // eg. "frames/%04d.jpg", see cv::VideoCapture), one frame after another.
+    // Frames are decoded on a separate thread, into a few buffers recycled between frames.
+    // With tracking enabled, frames following ones with detections are only processed
+    // within a margin around those, with a full scan every few frames to catch new logos.
+    class StreamProcessor
+    {
+    public:
+        // "0" means one thread per CPU core
+        const void setThreadsCount(const unsigned int& threadsCount);
+        // Downscaling factor of coarse-to-fine scans (used by full scans), "0" means full scans
+        const void setPreScanFactor(const unsigned int& preScanFactor);
+        // Margin (in pixels) around previous frame's detections, "0" disables tracking
+        const void setTrackingMargin(const unsigned int& trackingMargin);
+        // Maximum number of frames between full scans when tracking, "0" is treated as "1"
+        const void setFullScanInterval(const unsigned int& fullScanInterval);
+
+        // Writes one JSON line per frame to "output", then reports latency and sustained FPS
+        const void run(const std::string& source, std::ostream& output) const;
+
+    protected:
+        unsigned int threadsCount = 0;
+        unsigned int preScanFactor = 0;
+        unsigned int trackingMargin = 0;
+        unsigned int fullScanInterval = 30;
+    };
+}
+
+#endif
@@ -0,0 +1,43 @@
+#ifndef POBR_UTILS_BOUNDEDQUEUE_HPP
+#define POBR_UTILS_BOUNDEDQUEUE_HPP
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+namespace pobr::utils
+{
+    // Blocking multi-producer / multi-consumer FIFO with a fixed capacity,
+    // used to connect pipeline stages without buffering unbounded amounts of data
+    template<class Item>
+    class BoundedQueue
+    {
+    public:
+        // "0" is treated as "1"
+        explicit BoundedQueue(const size_t& capacity);
+
+        BoundedQueue(const BoundedQueue&) = delete;
+        BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+        // Waits while the queue is full, returns false (dropping the item) if it got closed
+        const bool push(Item item);
+        // Waits while the queue is empty, returns false once it got closed and drained
+        const bool pop(Item& item);
+        // Wakes up everyone waiting, no more items are accepted afterwards
+        const void close();
+
+    protected:
+        const size_t capacity;
+
+        std::deque<Item> items;
+        std::mutex mutex;
+        std::condition_variable notFullCondition;
+        std::condition_variable notEmptyCondition;
+        bool isClosed = false;
+    };
+}
+
+#include "./BoundedQueue.impl.hpp"
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef POBR_UTILS_BOUNDEDQUEUE_IMPL_HPP
+#define POBR_UTILS_BOUNDEDQUEUE_IMPL_HPP
+
+#include "./BoundedQueue.hpp"
+
+#include <algorithm>
+#include <utility>
+
+template<class Item>
+pobr::utils::BoundedQueue<Item>::BoundedQueue(const size_t& capacity):
+    capacity(std::max<size_t>(1, capacity))
+{}
+
+template<class Item>
+const bool
+pobr::utils::BoundedQueue<Item>::push(Item item)
+{
+    std::unique_lock<std::mutex> lock(this->mutex);
+
+    this->notFullCondition.wait(lock, [this]() {
+        return this->isClosed || this->items.size() < this->capacity;
+    });
+
+    if (this->isClosed) {
+        return false;
+    }
+
+    this->items.push_back(std::move(item));
+
+    lock.unlock();
+    this->notEmptyCondition.notify_one();
+
+    return true;
+}
+
+template<class Item>
+const bool
+pobr::utils::BoundedQueue<Item>::pop(Item& item)
+{
+    std::unique_lock<std::mutex> lock(this->mutex);
+
+    this->notEmptyCondition.wait(lock, [this]() {
+        return this->isClosed || !this->items.empty();
+    });
+
+    if (this->items.empty()) {
+        return false;
+    }
+
+    item = std::move(this->items.front());
+    this->items.pop_front();
+
+    lock.unlock();
+    this->notFullCondition.notify_one();
+
+    return true;
+}
+
+template<class Item>
+const void
+pobr::utils::BoundedQueue<Item>::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        this->isClosed = true;
+    }
+
+    this->notFullCondition.notify_all();
+    this->notEmptyCondition.notify_all();
+}
+
+#endif
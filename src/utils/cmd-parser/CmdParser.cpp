@@ -1,7 +1,15 @@
 #include "./CmdParser.hpp"
 
+#include <cmath>
+#include <cerrno>
+#include <cctype>
+#include <cstdlib>
+#include <limits>
 #include <algorithm>
 
+#include "../logger/Logger.hpp"
+
+using Logger = pobr::utils::Logger;
 using CmdParser = pobr::utils::CmdParser;
 
 CmdParser::CmdParser(const std::vector<std::string> args):
@@ -49,3 +57,121 @@ const
 
     return (*iter).substr(valIter);
 }
+
+const unsigned int
+CmdParser::getPositiveIntegerFlagValue(const std::string& flagName)
+const
+{
+    const auto value = this->getFlagValue(flagName);
+
+    unsigned int number = 0;
+
+    if (!CmdParser::parseInteger(value, number) || number == 0) {
+        Logger::error("Flag \"--" + flagName + "\" expects a positive integer, got \"" + value + "\"");
+    }
+
+    return number;
+}
+
+const unsigned int
+CmdParser::getNonNegativeIntegerFlagValue(const std::string& flagName)
+const
+{
+    const auto value = this->getFlagValue(flagName);
+
+    unsigned int number = 0;
+
+    if (!CmdParser::parseInteger(value, number)) {
+        Logger::error("Flag \"--" + flagName + "\" expects a non-negative integer, got \"" + value + "\"");
+    }
+
+    return number;
+}
+
+const std::vector<unsigned int>
+CmdParser::getPositiveIntegerListFlagValue(const std::string& flagName)
+const
+{
+    const auto value = this->getFlagValue(flagName);
+
+    std::vector<unsigned int> numbers;
+
+    size_t itemStart = 0;
+
+    // Note: empty items (eg. "1,,2" or a trailing comma) are errors as well
+    while (true) {
+        const auto itemEnd = std::min(value.find(',', itemStart), value.length());
+
+        unsigned int number = 0;
+
+        if (!CmdParser::parseInteger(value.substr(itemStart, itemEnd - itemStart), number) || number == 0) {
+            Logger::error(
+                "Flag \"--" + flagName + "\" expects a comma separated list of positive integers, " +
+                "got \"" + value + "\""
+            );
+        }
+
+        numbers.push_back(number);
+
+        if (itemEnd == value.length()) {
+            break;
+        }
+
+        itemStart = itemEnd + 1;
+    }
+
+    return numbers;
+}
+
+const double
+CmdParser::getNumberFlagValue(const std::string& flagName)
+const
+{
+    const auto value = this->getFlagValue(flagName);
+
+    char* end = nullptr;
+
+    errno = 0;
+
+    const double number = std::strtod(value.c_str(), &end);
+
+    // Note: strtod would skip leading whitespace, and take "inf" or "nan" as well
+    if (
+        value.empty() ||
+        std::isspace((unsigned char) value[0]) ||
+        end == value.c_str() ||
+        *end != '\0' ||
+        errno == ERANGE ||
+        !std::isfinite(number)
+    ) {
+        Logger::error("Flag \"--" + flagName + "\" expects a number, got \"" + value + "\"");
+    }
+
+    return number;
+}
+
+const bool
+CmdParser::parseInteger(const std::string& value, unsigned int& number)
+{
+    // Note: strtoull would take leading whitespace and signs, digits alone are allowed
+    const bool hasDigitsOnly = (
+        !value.empty() &&
+        value.find_first_not_of("0123456789") == std::string::npos
+    );
+
+    if (!hasDigitsOnly) {
+        return false;
+    }
+
+    errno = 0;
+
+    const auto parsedNumber = std::strtoull(value.c_str(), nullptr, 10);
+
+    if (errno == ERANGE || parsedNumber > std::numeric_limits<unsigned int>::max()) {
+        return false;
+    }
+
+    number = parsedNumber;
+
+    return true;
+}
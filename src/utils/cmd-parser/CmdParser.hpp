@@ -14,9 +14,21 @@ namespace pobr::utils
 
         const bool hasFlag(const std::string& flagName) const;
         const std::string getFlagValue(const std::string& flagName) const;
+        // Value of a flag which has to be a whole number above 0, errors (see Logger::error) otherwise
+        const unsigned int getPositiveIntegerFlagValue(const std::string& flagName) const;
+        // Same as above, but "0" is allowed as well
+        const unsigned int getNonNegativeIntegerFlagValue(const std::string& flagName) const;
+        // Comma separated whole numbers above 0 (eg. "1,2,4"), errors (see Logger::error) otherwise
+        const std::vector<unsigned int> getPositiveIntegerListFlagValue(const std::string& flagName) const;
+        // Value of a flag which has to be a (finite) number, errors (see Logger::error) otherwise
+        const double getNumberFlagValue(const std::string& flagName) const;
 
     protected:
         const std::vector<std::string> arguments;
+
+        // Whole number written with digits alone, which fits in an unsigned int,
+        // returns false (leaving number untouched) for anything else
+        static const bool parseInteger(const std::string& value, unsigned int& number);
     };
 }
 
@@ -0,0 +1,44 @@
+#include "./json.hpp"
+
+namespace json = pobr::utils::json;
+
+const std::string
+json::escape(const std::string& text)
+{
+    const char* const hexDigits = "0123456789abcdef";
+
+    std::string escaped;
+
+    for (const auto& character: text) {
+        const auto code = static_cast<unsigned char>(character);
+
+        switch (character) {
+        case '"':
+            escaped += "\\\"";
+            break;
+        case '\\':
+            escaped += "\\\\";
+            break;
+        case '\n':
+            escaped += "\\n";
+            break;
+        case '\r':
+            escaped += "\\r";
+            break;
+        case '\t':
+            escaped += "\\t";
+            break;
+        default:
+            if (code < 0x20) {
+                escaped += "\\u00";
+                escaped += hexDigits[code >> 4];
+                escaped += hexDigits[code & 0x0F];
+            } else {
+                escaped += character;
+            }
+            break;
+        }
+    }
+
+    return escaped;
+}
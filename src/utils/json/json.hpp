@@ -0,0 +1,14 @@
+#ifndef POBR_UTILS_JSON_HPP
+#define POBR_UTILS_JSON_HPP
+
+#include <string>
+
+namespace pobr::utils::json
+{
+    // Text as the contents of a JSON string (without surrounding quotes):
+    // quotes and backslashes are escaped, and so are control characters
+    // ("\n", "\r" and "\t" as such, others as "\u00XX"), so it always fits on a single line
+    const std::string escape(const std::string& text);
+}
+
+#endif
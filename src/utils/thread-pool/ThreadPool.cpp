@@ -0,0 +1,167 @@
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <algorithm>
+#include <memory>
+#include <exception>
+
+using ThreadPool = pobr::utils::ThreadPool;
+
+namespace
+{
+    // Shared between the caller of parallelFor and queued helpers,
+    // which may start after the call has already returned
+    struct ParallelForState
+    {
+        uint64_t count = 0;
+        std::function<void(const uint64_t&)> task;
+
+        std::atomic<uint64_t> nextIdx { 0 };
+        std::atomic<uint64_t> doneCount { 0 };
+
+        std::mutex mutex;
+        std::condition_variable doneCondition;
+        std::exception_ptr exception;
+
+        void runAvailable()
+        {
+            uint64_t idx;
+
+            while ((idx = this->nextIdx.fetch_add(1)) < this->count) {
+                try {
+                    this->task(idx);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(this->mutex);
+
+                    if (!this->exception) {
+                        this->exception = std::current_exception();
+                    }
+                }
+
+                if (this->doneCount.fetch_add(1) + 1 == this->count) {
+                    std::lock_guard<std::mutex> lock(this->mutex);
+
+                    this->doneCondition.notify_all();
+                }
+            }
+        }
+    };
+}
+
+ThreadPool::ThreadPool(const unsigned int& threadsCount)
+{
+    const unsigned int count = ThreadPool::resolveThreadsCount(threadsCount);
+
+    for (unsigned int idx = 1; idx < count; idx++) {
+        this->workers.emplace_back([this]() { this->runWorker(); });
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->tasksMutex);
+
+        this->isStopping = true;
+    }
+
+    this->tasksCondition.notify_all();
+
+    for (auto& worker: this->workers) {
+        worker.join();
+    }
+}
+
+const unsigned int
+ThreadPool::getThreadsCount()
+const
+{
+    return this->workers.size() + 1;
+}
+
+const unsigned int
+ThreadPool::resolveThreadsCount(const unsigned int& threadsCount)
+{
+    if (threadsCount > 0) {
+        return threadsCount;
+    }
+
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+const void
+ThreadPool::parallelFor(
+    const uint64_t& count,
+    const std::function<void(const uint64_t&)>& task
+)
+{
+    if (count == 0) {
+        return;
+    }
+
+    if (count == 1 || this->workers.empty()) {
+        for (uint64_t idx = 0; idx < count; idx++) {
+            task(idx);
+        }
+
+        return;
+    }
+
+    auto state = std::make_shared<ParallelForState>();
+
+    state->count = count;
+    state->task = task;
+
+    const uint64_t helpersCount = std::min<uint64_t>(count - 1, this->workers.size());
+
+    {
+        std::lock_guard<std::mutex> lock(this->tasksMutex);
+
+        for (uint64_t idx = 0; idx < helpersCount; idx++) {
+            this->tasks.push_back([state]() { state->runAvailable(); });
+        }
+    }
+
+    this->tasksCondition.notify_all();
+
+    state->runAvailable();
+
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+
+        state->doneCondition.wait(
+            lock,
+            [&state]() { return state->doneCount.load() == state->count; }
+        );
+    }
+
+    if (state->exception) {
+        std::rethrow_exception(state->exception);
+    }
+}
+
+const void
+ThreadPool::runWorker()
+{
+    while (true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock<std::mutex> lock(this->tasksMutex);
+
+            this->tasksCondition.wait(
+                lock,
+                [this]() { return this->isStopping || !this->tasks.empty(); }
+            );
+
+            if (this->isStopping && this->tasks.empty()) {
+                return;
+            }
+
+            task = std::move(this->tasks.front());
+            this->tasks.pop_front();
+        }
+
+        task();
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef POBR_UTILS_THREADPOOL_HPP
+#define POBR_UTILS_THREADPOOL_HPP
+
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace pobr::utils
+{
+    // Fixed set of worker threads, meant to be created once and shared
+    class ThreadPool
+    {
+    public:
+        // threadsCount includes the calling thread (which takes part in parallelFor),
+        // so "1" means no workers at all, and "0" means one thread per CPU core
+        explicit ThreadPool(const unsigned int& threadsCount = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        const unsigned int getThreadsCount() const;
+
+        // Threads a pool created with threadsCount would have, "0" resolved to CPU cores
+        static const unsigned int resolveThreadsCount(const unsigned int& threadsCount);
+
+        // Calls task(idx) for each idx in [0, count), returns once all calls are done
+        // Note: safe to nest, as the calling thread keeps running tasks while waiting
+        const void parallelFor(
+            const uint64_t& count,
+            const std::function<void(const uint64_t&)>& task
+        );
+
+    protected:
+        std::vector<std::thread> workers;
+
+        std::deque<std::function<void()>> tasks;
+        std::mutex tasksMutex;
+        std::condition_variable tasksCondition;
+        bool isStopping = false;
+
+        const void runWorker();
+    };
+}
+
+#endif
@@ -0,0 +1,200 @@
+// Checks that mixAndBinarizeImage() gives exactly what mixImageColors() + binarizeImage() do,
+// over every BGR triple, for the pipeline's settings and a few edge cases
+// Note: SIMD bodies are picked at compile time, so this is built a few times
+//       (see CMakeLists.txt), once for each of them
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+#include "../src/utils/logger/Logger.hpp"
+#include "../src/img-processing/utils/binarization.hpp"
+
+namespace binarization = pobr::imgProcessing::utils::binarization;
+
+using Logger = pobr::utils::Logger;
+
+namespace
+{
+    struct Settings
+    {
+        cv::Vec3i coefficients;
+        unsigned int threshold;
+    };
+
+    const std::string
+    getCompiledPath()
+    {
+#if POBR_CONFIG_SIMD && defined(__AVX2__)
+        return "AVX2";
+#elif POBR_CONFIG_SIMD && defined(__SSSE3__)
+        return "SSE";
+#else
+        return "scalar";
+#endif
+    }
+
+    const std::string
+    describe(const Settings& settings)
+    {
+        return (
+            std::string("coefficients (") +
+            std::to_string(settings.coefficients[0]) + ", " +
+            std::to_string(settings.coefficients[1]) + ", " +
+            std::to_string(settings.coefficients[2]) +
+            std::string("), threshold ") +
+            std::to_string(settings.threshold)
+        );
+    }
+
+    // Every BGR triple once, row by row, with the last row padded by the first triples
+    // Note: the width leaves a tail of pixels after the last whole SIMD block of each row
+    cv::Mat
+    createAllTriplesImg()
+    {
+        const uint64_t triplesCount = 1 << 24;
+        const int cols = 4093;
+        const int rows = (triplesCount + cols - 1) / cols;
+
+        cv::Mat img(rows, cols, CV_8UC3);
+
+        uint64_t triple = 0;
+
+        for (int y = 0; y < rows; y++) {
+            auto row = img.ptr<uint8_t>(y);
+
+            for (int x = 0; x < cols; x++, triple++) {
+                const uint64_t value = triple % triplesCount;
+
+                row[(3 * x) + 0] = value & 0xFF;
+                row[(3 * x) + 1] = (value >> 8) & 0xFF;
+                row[(3 * x) + 2] = (value >> 16) & 0xFF;
+            }
+        }
+
+        return img;
+    }
+
+    cv::Mat
+    createRandomImg(const int& rows, const int& cols, std::mt19937& generator)
+    {
+        std::uniform_int_distribution<int> distribution(0, 255);
+
+        cv::Mat img(rows, cols, CV_8UC3);
+
+        for (int y = 0; y < rows; y++) {
+            auto row = img.ptr<uint8_t>(y);
+
+            for (int x = 0; x < 3 * cols; x++) {
+                row[x] = distribution(generator);
+            }
+        }
+
+        return img;
+    }
+
+    // Position of the first pixel differing between both results, "-1" if there is none
+    const int64_t
+    findMismatch(const cv::Mat& img, const Settings& settings)
+    {
+        const auto expectedImg = binarization::binarizeImage(
+            binarization::mixImageColors(img, settings.coefficients, false),
+            settings.threshold
+        );
+        const auto resultImg = binarization::mixAndBinarizeImage(img, settings.coefficients, settings.threshold);
+
+        if (resultImg.rows != img.rows || resultImg.cols != img.cols || resultImg.type() != CV_8UC1) {
+            return 0;
+        }
+
+        for (int y = 0; y < img.rows; y++) {
+            const auto expectedRow = expectedImg.ptr<uint8_t>(y);
+            const auto resultRow = resultImg.ptr<uint8_t>(y);
+
+            for (int x = 0; x < img.cols; x++) {
+                if (expectedRow[x] != resultRow[x]) {
+                    return ((int64_t) y * img.cols) + x;
+                }
+            }
+        }
+
+        return -1;
+    }
+
+    const bool
+    check(const std::string& caseName, const cv::Mat& img, const Settings& settings)
+    {
+        const auto mismatch = findMismatch(img, settings);
+
+        if (mismatch < 0) {
+            return true;
+        }
+
+        const auto pixel = img.ptr<uint8_t>(mismatch / img.cols) + (3 * (mismatch % img.cols));
+
+        Logger::error(
+            caseName + std::string(", ") + describe(settings) +
+            std::string(": results differ at pixel ") + std::to_string(mismatch) +
+            std::string(" (BGR ") +
+            std::to_string(pixel[0]) + ", " +
+            std::to_string(pixel[1]) + ", " +
+            std::to_string(pixel[2]) + ")",
+            true
+        );
+
+        return false;
+    }
+}
+
+int main()
+{
+    const std::vector<Settings> settingsList = {
+        // The pipeline's (see ImgProcessor::processBinarize)
+        { { -125, -140, 180 }, 50 },
+        { { -125, -140, 180 }, 0 },
+        { { -125, -140, 180 }, 254 },
+        { { -125, -140, 180 }, 255 },
+        // Lots of exact ties, resolved by floating point rounding
+        { { 100, 100, 100 }, 127 },
+        { { 30, 59, 11 }, 99 },
+        { { -1, 1, 1 }, 0 },
+        // Extreme weights, still within 16 bits
+        { { 32767, -32768, 1 }, 200 },
+        // Weights beyond 16 bits, only handled by the scalar loop
+        { { 40000, -40000, 100 }, 10 }
+    };
+
+    Logger::notice("Fused binarization path: " + getCompiledPath());
+
+    bool isPassing = true;
+
+    const auto allTriplesImg = createAllTriplesImg();
+
+    for (const auto& settings: settingsList) {
+        isPassing = check("every BGR triple", allTriplesImg, settings) && isPassing;
+    }
+
+    // Every tail length, on continuous images and on views starting at an odd byte,
+    // whose rows are not continuous either
+    std::mt19937 generator(2017);
+
+    for (int cols = 1; cols <= 48; cols++) {
+        const auto img = createRandomImg(5, cols, generator);
+        const auto paddedImg = createRandomImg(7, cols + 3, generator);
+        const auto viewImg = paddedImg(cv::Rect(1, 1, cols, 5));
+
+        for (const auto& settings: settingsList) {
+            isPassing = check(std::to_string(cols) + " columns", img, settings) && isPassing;
+            isPassing = check(std::to_string(cols) + " columns view", viewImg, settings) && isPassing;
+        }
+    }
+
+    if (!isPassing) {
+        return 1;
+    }
+
+    Logger::notice("Fused binarization matches color mixing followed by thresholding");
+
+    return 0;
+}
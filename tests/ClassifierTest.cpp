@@ -0,0 +1,63 @@
+// Checks that the built-in classifier model is the very same one as "models/tesco.txt",
+// and that a written model reads back as the same model
+// Note: run from repository's root, for "models/" to be found
+#include <string>
+#include <sstream>
+
+#include "../src/utils/logger/Logger.hpp"
+#include "../src/img-processing/structs/Classifier.hpp"
+
+using Logger = pobr::utils::Logger;
+using Classifier = pobr::imgProcessing::structs::Classifier;
+
+namespace
+{
+    const std::string
+    writeModel(const Classifier& model)
+    {
+        std::ostringstream output;
+
+        model.write(output);
+
+        return output.str();
+    }
+}
+
+int main()
+{
+    const std::string modelPath = "models/tesco.txt";
+
+    bool isPassing = true;
+
+    try
+    {
+        const auto builtInModel = writeModel(Classifier::getModel());
+        const auto fileModel = writeModel(Classifier::fromFile(modelPath));
+
+        if (builtInModel != fileModel) {
+            isPassing = false;
+
+            Logger::error("Built-in model differs from \"" + modelPath + "\"", true);
+        }
+
+        std::istringstream input(builtInModel);
+
+        if (writeModel(Classifier::fromStream(input, "written")) != builtInModel) {
+            isPassing = false;
+
+            Logger::error("Written model does not read back as the same model", true);
+        }
+    }
+    catch(Logger::Exception &e)
+    {
+        return 1;
+    }
+
+    if (!isPassing) {
+        return 1;
+    }
+
+    Logger::notice("Built-in model matches \"" + modelPath + "\" and reads back once written");
+
+    return 0;
+}
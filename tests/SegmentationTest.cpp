@@ -0,0 +1,447 @@
+// Checks that every segmentation method gives exactly what the flood fill does
+// (same label image, and same segments in the same order, with the same moments,
+// features and pixels),
+// on binarized images of "data/" and on synthetic edge cases
+// Note: run from repository's root, for "data/" to be found
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <string>
+#include <random>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <algorithm>
+#include <opencv2/core/core.hpp>
+
+#include "../src/utils/consts.hpp"
+#include "../src/utils/logger/Logger.hpp"
+#include "../src/utils/thread-pool/ThreadPool.hpp"
+#include "../src/img-processing/ImgProcessor.hpp"
+#include "../src/img-processing/utils/segmentation.hpp"
+
+namespace consts = pobr::utils::consts;
+namespace segmentation = pobr::imgProcessing::utils::segmentation;
+
+using Logger = pobr::utils::Logger;
+using ThreadPool = pobr::utils::ThreadPool;
+using ImgProcessor = pobr::imgProcessing::ImgProcessor;
+using Segment = pobr::imgProcessing::structs::Segment;
+using Moments = pobr::imgProcessing::structs::Moments;
+
+namespace
+{
+    typedef std::function<
+        std::vector<Segment>(const cv::Mat&, const bool&, cv::Mat_<int>*, segmentation::Workspace*)
+    > Method;
+
+    struct NamedMethod
+    {
+        std::string name;
+        Method method;
+    };
+
+    struct NamedImg
+    {
+        std::string name;
+        cv::Mat img;
+    };
+
+    // Negative, zero or positive, as left's pixels compare with right's
+    const int
+    comparePixels(const cv::Mat_<uint8_t>& left, const cv::Mat_<uint8_t>& right)
+    {
+        if (left.rows != right.rows) {
+            return (left.rows < right.rows ? -1 : 1);
+        }
+        if (left.cols != right.cols) {
+            return (left.cols < right.cols ? -1 : 1);
+        }
+
+        for (int y = 0; y < left.rows; y++) {
+            const auto result = std::memcmp(left.ptr<uint8_t>(y), right.ptr<uint8_t>(y), left.cols);
+
+            if (result != 0) {
+                return result;
+            }
+        }
+
+        return 0;
+    }
+
+    // Description of the first difference between both segments, empty if there is none
+    const std::string
+    compareSegments(const Segment& expected, const Segment& result)
+    {
+        if (
+            expected.xMin != result.xMin ||
+            expected.xMax != result.xMax ||
+            expected.yMin != result.yMin ||
+            expected.yMax != result.yMax
+        ) {
+            return "bounding box";
+        }
+        if (expected.getArea() != result.getArea()) {
+            return "area";
+        }
+        for (uint8_t p = 0; p <= Moments::maxOrder; p++) {
+            for (uint8_t q = 0; p + q <= Moments::maxOrder; q++) {
+                if (expected.getFeatures().moments.getRaw(p, q) != result.getFeatures().moments.getRaw(p, q)) {
+                    return "moment (" + std::to_string(p) + ", " + std::to_string(q) + ")";
+                }
+            }
+        }
+        if (expected.getFeatures().huInvariants != result.getFeatures().huInvariants) {
+            return "Hu invariants";
+        }
+        if (expected.getFeatures().huFeatures != result.getFeatures().huFeatures) {
+            return "Hu features";
+        }
+        if (expected.getFilterStage() != result.getFilterStage()) {
+            return "filter stage";
+        }
+        if (expected.classify() != result.classify()) {
+            return "classification";
+        }
+        if (expected.getClassIdx() != result.getClassIdx()) {
+            return "class";
+        }
+        if (
+            result.getLabelsView().rows != (int) result.getHeight() ||
+            result.getLabelsView().cols != (int) result.getWidth()
+        ) {
+            return "labels view size";
+        }
+        if (comparePixels(expected.getPixels(), result.getPixels()) != 0) {
+            return "pixels";
+        }
+
+        return "";
+    }
+
+    // Description of the first difference between both results, empty if there is none
+    // Note: label values themselves may differ (flood fill skips the ones it uses as markers),
+    //       as long as each expected label always comes with the same label of the result,
+    //       and the other way around
+    // Note: all methods return segments in raster order of their first pixel,
+    //       so they are compared in order
+    const std::string
+    compareResults(
+        const std::vector<Segment>& expectedSegments,
+        const cv::Mat_<int>& expectedLabels,
+        const std::vector<Segment>& segments,
+        const cv::Mat_<int>& labels
+    )
+    {
+        if (expectedLabels.rows != labels.rows || expectedLabels.cols != labels.cols) {
+            return "label image size";
+        }
+
+        std::map<int, int> labelsMap = { { 0, 0 } };
+        std::map<int, int> reverseLabelsMap = { { 0, 0 } };
+
+        for (int y = 0; y < labels.rows; y++) {
+            const auto expectedRow = expectedLabels.ptr<int>(y);
+            const auto row = labels.ptr<int>(y);
+
+            for (int x = 0; x < labels.cols; x++) {
+                const auto labelIt = labelsMap.emplace(expectedRow[x], row[x]).first;
+                const auto reverseLabelIt = reverseLabelsMap.emplace(row[x], expectedRow[x]).first;
+
+                if (labelIt->second != row[x] || reverseLabelIt->second != expectedRow[x]) {
+                    return "label at (" + std::to_string(x) + ", " + std::to_string(y) + ")";
+                }
+            }
+        }
+
+        if (expectedSegments.size() != segments.size()) {
+            return (
+                std::to_string(segments.size()) + std::string(" segments instead of ") +
+                std::to_string(expectedSegments.size())
+            );
+        }
+
+        for (size_t idx = 0; idx < expectedSegments.size(); idx++) {
+            const auto labelIt = labelsMap.find(expectedSegments[idx].label);
+
+            if (labelIt == labelsMap.end() || labelIt->second != segments[idx].label) {
+                return "label of segment " + std::to_string(idx);
+            }
+
+            const auto difference = compareSegments(expectedSegments[idx], segments[idx]);
+
+            if (!difference.empty()) {
+                return difference + " of segment " + std::to_string(idx);
+            }
+        }
+
+        return "";
+    }
+
+    cv::Mat
+    createImg(const int& rows, const int& cols, const uint8_t& color)
+    {
+        cv::Mat img(rows, cols, CV_8UC1);
+
+        img.setTo(color);
+
+        return img;
+    }
+
+    cv::Mat
+    createNoiseImg(const int& rows, const int& cols, const double& whiteRatio, std::mt19937& generator)
+    {
+        std::bernoulli_distribution distribution(whiteRatio);
+
+        auto img = createImg(rows, cols, consts::colors::black);
+
+        for (int y = 0; y < rows; y++) {
+            auto row = img.ptr<uint8_t>(y);
+
+            for (int x = 0; x < cols; x++) {
+                row[x] = (distribution(generator) ? consts::colors::white : consts::colors::black);
+            }
+        }
+
+        return img;
+    }
+
+    const std::vector<NamedImg>
+    createSyntheticImgs()
+    {
+        const auto white = consts::colors::white;
+        const auto black = consts::colors::black;
+
+        std::vector<NamedImg> imgs;
+
+        imgs.push_back({ "1x1 white", createImg(1, 1, white) });
+        imgs.push_back({ "1x1 black", createImg(1, 1, black) });
+        imgs.push_back({ "fully white", createImg(48, 37, white) });
+        imgs.push_back({ "fully black", createImg(48, 37, black) });
+
+        // One pixel wide or tall, with runs of a few lengths
+        auto columnImg = createImg(61, 1, black);
+        auto rowImg = createImg(1, 61, black);
+
+        for (int idx = 0; idx < 61; idx++) {
+            const auto color = ((idx % 7) < (idx % 5) ? white : black);
+
+            columnImg.at<uint8_t>(idx, 0) = color;
+            rowImg.at<uint8_t>(0, idx) = color;
+        }
+
+        imgs.push_back({ "1 pixel wide", columnImg });
+        imgs.push_back({ "1 pixel tall", rowImg });
+
+        // Only diagonal neighbours touch
+        auto checkerboardImg = createImg(17, 23, black);
+
+        for (int y = 0; y < checkerboardImg.rows; y++) {
+            for (int x = 0; x < checkerboardImg.cols; x++) {
+                checkerboardImg.at<uint8_t>(y, x) = ((x + y) % 2 == 0 ? white : black);
+            }
+        }
+
+        imgs.push_back({ "checkerboard", checkerboardImg });
+
+        // Shapes crossing every strip border: teeth of a comb joined at the bottom row only,
+        // a staircase only connected diagonally, and letters spanning the whole image
+        auto stripsImg = createImg(67, 90, black);
+
+        for (int y = 0; y < stripsImg.rows; y++) {
+            auto row = stripsImg.ptr<uint8_t>(y);
+
+            for (int x = 1; x < 30; x += 4) {
+                row[x] = white;
+            }
+            if (y == stripsImg.rows - 2) {
+                std::fill(row + 1, row + 30, white);
+            }
+
+            row[32 + (y % 24)] = white;
+
+            if (y > 1 && y < stripsImg.rows - 2) {
+                row[60] = white;
+                row[61] = white;
+                row[78] = white;
+                row[79] = white;
+            }
+            if (y == 2 || y == stripsImg.rows / 2 || y == stripsImg.rows - 3) {
+                std::fill(row + 60, row + 80, white);
+            }
+        }
+
+        imgs.push_back({ "shapes across strips", stripsImg });
+
+        std::mt19937 generator(2017);
+
+        for (const auto& whiteRatio: { 0.2, 0.5, 0.8 }) {
+            imgs.push_back({
+                "noise (" + std::to_string((int) (whiteRatio * 100)) + "% white)",
+                createNoiseImg(97, 101, whiteRatio, generator)
+            });
+        }
+
+        // Rows of a view are not continuous
+        const auto paddedImg = createNoiseImg(70, 90, 0.6, generator);
+
+        imgs.push_back({ "noise view", paddedImg(cv::Rect(3, 5, 81, 61)) });
+
+        return imgs;
+    }
+
+    // Binarized the way the pipeline does (see ImgProcessor::getBinarizedImg)
+    const std::vector<NamedImg>
+    loadDataImgs()
+    {
+        std::vector<std::string> imgPaths;
+
+        cv::glob("data/*.jpg", imgPaths);
+        std::sort(imgPaths.begin(), imgPaths.end());
+
+        std::vector<NamedImg> imgs;
+
+        for (const auto& imgPath: imgPaths) {
+            auto imgProcessor = ImgProcessor();
+
+            imgProcessor.loadImg(imgPath);
+
+            imgs.push_back({ imgPath, imgProcessor.getBinarizedImg() });
+        }
+
+        return imgs;
+    }
+}
+
+int main()
+{
+    auto imgs = loadDataImgs();
+
+    if (imgs.empty()) {
+        Logger::error("No images found in \"data/\", run from repository's root", true);
+
+        return 1;
+    }
+
+    const auto syntheticImgs = createSyntheticImgs();
+
+    imgs.insert(imgs.end(), syntheticImgs.begin(), syntheticImgs.end());
+
+    // Note: more threads than rows of the smallest images, so some strips stay empty
+    auto singleThreadPool = std::make_shared<ThreadPool>(1);
+    auto threadPool = std::make_shared<ThreadPool>(3);
+    auto manyThreadPool = std::make_shared<ThreadPool>(8);
+
+    const std::vector<NamedMethod> methods = {
+        {
+            "union-find",
+            [](const cv::Mat& img, const bool& diag, cv::Mat_<int>* labels, segmentation::Workspace* workspace) {
+                return segmentation::getImageSegmentsUnionFind(img, diag, labels, workspace);
+            }
+        },
+        {
+            "union-find (3 threads)",
+            [threadPool](const cv::Mat& img, const bool& diag, cv::Mat_<int>* labels, segmentation::Workspace* workspace) {
+                return segmentation::getImageSegmentsUnionFind(img, diag, labels, workspace, threadPool.get());
+            }
+        },
+        {
+            "parallel union-find (1 thread)",
+            [singleThreadPool](const cv::Mat& img, const bool& diag, cv::Mat_<int>* labels, segmentation::Workspace* workspace) {
+                return segmentation::getImageSegmentsUnionFindParallel(img, *singleThreadPool, diag, labels, workspace);
+            }
+        },
+        {
+            "parallel union-find (3 threads)",
+            [threadPool](const cv::Mat& img, const bool& diag, cv::Mat_<int>* labels, segmentation::Workspace* workspace) {
+                return segmentation::getImageSegmentsUnionFindParallel(img, *threadPool, diag, labels, workspace);
+            }
+        },
+        {
+            "parallel union-find (8 threads)",
+            [manyThreadPool](const cv::Mat& img, const bool& diag, cv::Mat_<int>* labels, segmentation::Workspace* workspace) {
+                return segmentation::getImageSegmentsUnionFindParallel(img, *manyThreadPool, diag, labels, workspace);
+            }
+        },
+        {
+            "scan-merge",
+            [](const cv::Mat& img, const bool& diag, cv::Mat_<int>* labels, segmentation::Workspace* workspace) {
+                return segmentation::getImageSegmentsScanMerge(img, diag, labels, workspace);
+            }
+        },
+        {
+            "scan-merge (3 threads)",
+            [threadPool](const cv::Mat& img, const bool& diag, cv::Mat_<int>* labels, segmentation::Workspace* workspace) {
+                return segmentation::getImageSegmentsScanMerge(img, diag, labels, workspace, threadPool.get());
+            }
+        }
+    };
+
+    bool isPassing = true;
+    uint64_t checksCount = 0;
+
+    for (const auto& diagDetection: { false, true }) {
+        // Note: one workspace per method, reused over all images (from large to tiny ones)
+        std::vector<std::unique_ptr<segmentation::Workspace>> workspaces;
+
+        for (size_t idx = 0; idx < methods.size(); idx++) {
+            workspaces.emplace_back(new segmentation::Workspace());
+        }
+
+        for (const auto& namedImg: imgs) {
+            cv::Mat_<int> expectedLabels;
+
+            const auto expectedSegments = segmentation::getImageSegmentsFloodFill(
+                namedImg.img,
+                diagDetection,
+                &expectedLabels
+            );
+
+            for (size_t idx = 0; idx < methods.size(); idx++) {
+                for (const auto& hasWorkspace: { false, true }) {
+                    cv::Mat_<int> labels;
+
+                    const auto segments = methods[idx].method(
+                        namedImg.img,
+                        diagDetection,
+                        &labels,
+                        (hasWorkspace ? workspaces[idx].get() : nullptr)
+                    );
+
+                    const auto difference = compareResults(expectedSegments, expectedLabels, segments, labels);
+
+                    checksCount++;
+
+                    if (difference.empty()) {
+                        continue;
+                    }
+
+                    isPassing = false;
+
+                    Logger::error(
+                        methods[idx].name +
+                        std::string(" on \"") + namedImg.name + std::string("\"") +
+                        (diagDetection ? " (diagonal)" : "") +
+                        (hasWorkspace ? " (reused workspace)" : "") +
+                        std::string(": ") + difference + std::string(" differs from flood fill"),
+                        true
+                    );
+                }
+            }
+        }
+    }
+
+    if (!isPassing) {
+        return 1;
+    }
+
+    Logger::notice(
+        std::string("All segmentation methods match flood fill (") +
+        std::to_string(checksCount) +
+        std::string(" checks on ") +
+        std::to_string(imgs.size()) +
+        std::string(" images)")
+    );
+
+    return 0;
+}
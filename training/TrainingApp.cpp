@@ -0,0 +1,404 @@
+#include "TrainingApp.hpp"
+
+#include <cmath>
+#include <atomic>
+#include <thread>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <algorithm>
+#include <opencv2/highgui/highgui.hpp>
+
+#include "../src/utils/logger/Logger.hpp"
+#include "../src/utils/cmd-parser/CmdParser.hpp"
+#include "../src/utils/performance-timer/PerformanceTimer.hpp"
+
+using Logger = pobr::utils::Logger;
+using CmdParser = pobr::utils::CmdParser;
+using PerformanceTimer = pobr::utils::PerformanceTimer;
+using ImgProcessor = pobr::imgProcessing::ImgProcessor;
+using Classifier = pobr::imgProcessing::structs::Classifier;
+using Segment = pobr::imgProcessing::structs::Segment;
+
+using TrainingApp = pobr::training::TrainingApp;
+
+namespace
+{
+    const double
+    getOverlap(const cv::Rect& left, const cv::Rect& right)
+    {
+        const double intersectionArea = (left & right).area();
+
+        return intersectionArea / (left.area() + right.area() - intersectionArea);
+    }
+}
+
+TrainingApp::TrainingApp(const std::vector<std::string>& arguments)
+{
+    try
+    {
+        auto cmdParser = CmdParser(arguments);
+
+        if (cmdParser.hasFlag("labels")) {
+            this->config.labelsPath = cmdParser.getFlagValue("labels");
+        }
+        if (cmdParser.hasFlag("word")) {
+            this->config.word = cmdParser.getFlagValue("word");
+        }
+        if (cmdParser.hasFlag("classes")) {
+            this->config.classLetters = cmdParser.getFlagValue("classes");
+        }
+        if (cmdParser.hasFlag("min-deviation")) {
+            this->config.minDeviation = cmdParser.getNumberFlagValue("min-deviation");
+        }
+        if (cmdParser.hasFlag("shrinkage")) {
+            this->config.shrinkage = cmdParser.getNumberFlagValue("shrinkage");
+        }
+        if (cmdParser.hasFlag("max-distance")) {
+            this->config.maxDistance = cmdParser.getNumberFlagValue("max-distance");
+        }
+        if (cmdParser.hasFlag("workers")) {
+            this->config.workersCount = cmdParser.getPositiveIntegerFlagValue("workers");
+        }
+        if (cmdParser.hasFlag("output")) {
+            this->config.outputPath = cmdParser.getFlagValue("output");
+        }
+
+        if (this->config.minDeviation <= 0) {
+            Logger::error("Flag \"--min-deviation\" has to be above 0");
+        }
+        if (this->config.shrinkage < 0 || this->config.shrinkage > 1) {
+            Logger::error("Flag \"--shrinkage\" has to be between 0 and 1");
+        }
+        if (this->config.maxDistance <= 0) {
+            Logger::error("Flag \"--max-distance\" has to be above 0");
+        }
+
+        if (this->config.classLetters.empty()) {
+            for (const auto& letter: this->config.word) {
+                if (this->config.classLetters.find(letter) == std::string::npos) {
+                    this->config.classLetters += letter;
+                }
+            }
+        }
+
+        PerformanceTimer timer;
+
+        timer.start();
+
+        const auto labelledImgs = this->loadLabels();
+        const auto imgsSamples = this->collectSamples(labelledImgs);
+        const auto model = this->buildModel(imgsSamples);
+
+        timer.stop();
+
+        uint64_t samplesCount = 0;
+
+        for (const auto& imgSamples: imgsSamples) {
+            samplesCount += imgSamples.samples.size();
+        }
+
+        std::stringstream modelText;
+
+        modelText << "# Classifier model trained by eiti_pobr_training\n";
+        modelText << "# on " << samplesCount << " letters of \"" << this->config.labelsPath << "\"";
+        modelText << ", with deviations of at least " << this->config.minDeviation;
+        modelText << " and covariances shrunk by " << this->config.shrinkage << "\n\n";
+
+        model.write(modelText);
+
+        if (this->config.outputPath.empty()) {
+            std::cout << modelText.str();
+        } else {
+            std::ofstream output(this->config.outputPath);
+
+            if (!output) {
+                Logger::error("Could not open \"" + this->config.outputPath + "\" for writing");
+            }
+
+            output << modelText.str();
+
+            Logger::notice("Model written to \"" + this->config.outputPath + "\"");
+            Logger::notice(
+                std::string("Trained on ") +
+                std::to_string(samplesCount) +
+                std::string(" letters of ") +
+                std::to_string(labelledImgs.size()) +
+                std::string(" images in ") +
+                std::to_string(timer.getDurationNS() / 1000000000) +
+                std::string("s")
+            );
+        }
+    }
+    catch(Logger::Exception &e)
+    {
+        Logger::error("Terminating...", true);
+    }
+}
+
+const std::vector<TrainingApp::LabelledImg>
+TrainingApp::loadLabels()
+const
+{
+    std::ifstream input(this->config.labelsPath);
+
+    if (!input.is_open()) {
+        Logger::error("Could not open labels \"" + this->config.labelsPath + "\"");
+    }
+
+    const auto separatorPos = this->config.labelsPath.find_last_of('/');
+    const std::string dirPath = (
+        separatorPos == std::string::npos ?
+        "" :
+        this->config.labelsPath.substr(0, separatorPos + 1)
+    );
+
+    std::vector<LabelledImg> labelledImgs;
+    std::string line;
+    uint64_t lineNo = 0;
+
+    while (std::getline(input, line)) {
+        lineNo++;
+
+        std::istringstream lineStream(line.substr(0, line.find('#')));
+        std::string imgPath;
+
+        if (!(lineStream >> imgPath)) {
+            continue;
+        }
+
+        std::string letter;
+        int xMin, yMin, xMax, yMax;
+
+        if (!(lineStream >> letter >> xMin >> yMin >> xMax >> yMax) || letter.size() != 1 || xMax < xMin || yMax < yMin) {
+            Logger::error("Invalid label at line " + std::to_string(lineNo) + " of \"" + this->config.labelsPath + "\"");
+        }
+
+        imgPath = dirPath + imgPath;
+
+        // Note: labels of an image are expected to be listed together
+        if (labelledImgs.empty() || labelledImgs.back().path != imgPath) {
+            labelledImgs.push_back({ imgPath, {} });
+        }
+
+        Label label;
+
+        label.letter = letter[0];
+        label.bbox = cv::Rect(xMin, yMin, xMax - xMin + 1, yMax - yMin + 1);
+
+        labelledImgs.back().labels.push_back(label);
+    }
+
+    if (labelledImgs.empty()) {
+        Logger::error("No labels found in \"" + this->config.labelsPath + "\"");
+    }
+
+    return labelledImgs;
+}
+
+const std::vector<TrainingApp::ImgSamples>
+TrainingApp::collectSamples(const std::vector<LabelledImg>& labelledImgs)
+const
+{
+    std::vector<ImgSamples> imgsSamples(labelledImgs.size());
+
+    const unsigned int workersCount = std::min<uint64_t>(
+        labelledImgs.size(),
+        (this->config.workersCount > 0 ? this->config.workersCount : std::max(1u, std::thread::hardware_concurrency()))
+    );
+
+    std::atomic<uint64_t> nextImgIdx { 0 };
+    std::vector<std::thread> workers;
+
+    for (unsigned int workerIdx = 0; workerIdx < workersCount; workerIdx++) {
+        workers.emplace_back([&]() -> void
+        {
+            // Note: images are spread over workers, so each ImgProcessor gets a single thread
+            auto imgProcessor = ImgProcessor();
+
+            imgProcessor.setThreadsCount(1);
+
+            uint64_t imgIdx;
+
+            while ((imgIdx = nextImgIdx.fetch_add(1)) < labelledImgs.size()) {
+                try
+                {
+                    imgsSamples[imgIdx] = this->collectImgSamples(labelledImgs[imgIdx], imgProcessor);
+                }
+                catch(std::exception &e)
+                {
+                    imgsSamples[imgIdx].error = e.what();
+                }
+            }
+        });
+    }
+
+    for (auto& worker: workers) {
+        worker.join();
+    }
+
+    // Note: reported in input order, once all images are done
+    for (size_t imgIdx = 0; imgIdx < labelledImgs.size(); imgIdx++) {
+        const auto& imgPath = labelledImgs[imgIdx].path;
+        const auto& imgSamples = imgsSamples[imgIdx];
+
+        if (!imgSamples.error.empty()) {
+            Logger::warning("Skipped \"" + imgPath + "\": " + imgSamples.error);
+        }
+        if (imgSamples.unmatchedCount > 0) {
+            Logger::warning(
+                std::to_string(imgSamples.unmatchedCount) +
+                std::string(" labels of \"") + imgPath + std::string("\" match no segment")
+            );
+        }
+    }
+
+    return imgsSamples;
+}
+
+const TrainingApp::ImgSamples
+TrainingApp::collectImgSamples(const LabelledImg& labelledImg, ImgProcessor& imgProcessor)
+const
+{
+    ImgSamples imgSamples;
+
+    const auto img = cv::imread(labelledImg.path);
+
+    if (img.empty()) {
+        imgSamples.error = "could not properly load image";
+
+        return imgSamples;
+    }
+
+    imgProcessor.setImg(img);
+
+    const auto& segments = imgProcessor.getSegments();
+
+    for (const auto& label: labelledImg.labels) {
+        const Segment* bestSegment = nullptr;
+        double bestOverlap = TrainingApp::minLabelOverlap;
+
+        for (const auto& segment: segments) {
+            const cv::Rect segmentBBox(segment.xMin, segment.yMin, segment.getWidth(), segment.getHeight());
+
+            if ((segmentBBox & label.bbox).area() == 0) {
+                continue;
+            }
+
+            const auto overlap = getOverlap(segmentBBox, label.bbox);
+
+            if (overlap >= bestOverlap) {
+                bestSegment = &segment;
+                bestOverlap = overlap;
+            }
+        }
+
+        if (bestSegment == nullptr) {
+            imgSamples.unmatchedCount++;
+
+            continue;
+        }
+
+        Sample sample;
+
+        sample.letter = label.letter;
+        sample.huInvariants = bestSegment->computeHuInvariants();
+        sample.isGeometryRejected = (bestSegment->getFilterStage() < Segment::FilterStage::HuInvariant1);
+
+        imgSamples.samples.push_back(sample);
+    }
+
+    return imgSamples;
+}
+
+const Classifier
+TrainingApp::buildModel(const std::vector<ImgSamples>& imgsSamples)
+const
+{
+    const auto& classLetters = this->config.classLetters;
+
+    std::vector<std::vector<Classifier::Features>> classSamples(classLetters.size());
+    uint64_t geometryRejectedCount = 0;
+
+    for (const auto& imgSamples: imgsSamples) {
+        for (const auto& sample: imgSamples.samples) {
+            const auto classIdx = classLetters.find(sample.letter);
+
+            if (classIdx == std::string::npos) {
+                continue;
+            }
+
+            // Note: would only skew centroids, as no model gets them classified
+            if (sample.isGeometryRejected) {
+                geometryRejectedCount++;
+
+                continue;
+            }
+
+            classSamples[classIdx].push_back(Classifier::toFeatures(sample.huInvariants));
+        }
+    }
+
+    std::vector<Classifier::Centroid> classCentroids(classLetters.size());
+
+    for (size_t classIdx = 0; classIdx < classLetters.size(); classIdx++) {
+        const auto letter = std::string(1, classLetters[classIdx]);
+        const auto& samples = classSamples[classIdx];
+
+        if (samples.empty()) {
+            Logger::error("No labelled letters \"" + letter + "\" matched any segment");
+        }
+
+        // Note: progress goes to stdout as well, so it's only shown when the model does not
+        if (!this->config.outputPath.empty()) {
+            Logger::notice("Class \"" + letter + "\": " + std::to_string(samples.size()) + " letters");
+        }
+
+        std::array<double, Classifier::invariantsCount> means = {};
+
+        for (const auto& features: samples) {
+            for (uint8_t no = 0; no < Classifier::invariantsCount; no++) {
+                means[no] += features[no] / samples.size();
+            }
+        }
+
+        auto& centroid = classCentroids[classIdx];
+
+        for (uint8_t row = 0; row < Classifier::invariantsCount; row++) {
+            centroid.means[row] = means[row];
+
+            for (uint8_t column = 0; column < Classifier::invariantsCount; column++) {
+                double covariance = 0;
+
+                for (const auto& features: samples) {
+                    covariance += (features[row] - means[row]) * (features[column] - means[column]);
+                }
+
+                covariance /= samples.size();
+
+                // Note: a few samples of a class are far too few to tell all 21 covariances
+                //       between features apart, so these are scaled down towards independent features,
+                //       while variances are kept from leaving no room for other letters
+                //       than the very ones they come from
+                if (row != column) {
+                    covariance *= 1 - this->config.shrinkage;
+                } else {
+                    covariance = std::max(covariance, this->config.minDeviation * this->config.minDeviation);
+                }
+
+                centroid.covariances[row][column] = covariance;
+            }
+        }
+    }
+
+    if (geometryRejectedCount > 0) {
+        Logger::warning(
+            std::to_string(geometryRejectedCount) +
+            std::string(" letters skipped, as they fail classifier's cheaper checks (see Segment::FilterStage)")
+        );
+    }
+
+    const std::vector<char> letters(classLetters.begin(), classLetters.end());
+
+    return Classifier::fromCentroids(this->config.word, letters, classCentroids, this->config.maxDistance, "training");
+}
@@ -0,0 +1,95 @@
+#ifndef POBR_TRAINING_TRAININGAPP_HPP
+#define POBR_TRAINING_TRAININGAPP_HPP
+
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <string>
+#include <opencv2/core/core.hpp>
+
+#include "../src/img-processing/ImgProcessor.hpp"
+
+namespace pobr::training
+{
+    // Builds a classifier model (see models/tesco.txt) from labelled images:
+    // runs the detection pipeline up to segmentation on each of them (on multiple threads),
+    // matches labelled letters with segments and takes the centroid and covariances
+    // of their features (see Classifier::toFeatures), computed from Hu invariants
+    // by Segment itself, so they are the very ones classified at runtime
+    //
+    // Flags:
+    //   --labels=<path>    labelled letters, one "<image> <letter> <xMin> <yMin> <xMax> <yMax>"
+    //                      per line (image paths relative to this file), defaults to "data/labels.txt"
+    //                      (bootstrapped from the built-in model's detections, not ground truth)
+    //   --word=<letters>   word to detect, defaults to "TESCO"
+    //   --classes=<letters> classes of the model, defaults to word's letters
+    //                      (labels of other letters are ignored), the first one wins ties
+    //   --min-deviation=<value> lowest deviation of a feature (above 0), defaults to 0.05
+    //   --shrinkage=<ratio> scales covariances between different features down by this part
+    //                      (between 0 and 1), defaults to 0.01
+    //   --max-distance=<value> furthest a letter may be from its centroid (see Classifier::classify),
+    //                      above 0, defaults to 2.5
+    //   --workers=<N>      images processed at once, defaults to one per CPU core
+    //   --output=<path>    model destination, defaults to stdout
+    class TrainingApp
+    {
+    public:
+        TrainingApp() = delete;
+        explicit TrainingApp(const std::vector<std::string>& arguments);
+
+    protected:
+        // Segments overlapping a label by less than this (intersection over union) never match it
+        static constexpr double minLabelOverlap = 0.5;
+
+        struct Config
+        {
+            std::string labelsPath = "data/labels.txt";
+            std::string word = "TESCO";
+            std::string classLetters;
+            double minDeviation = 0.05;
+            double shrinkage = 0.01;
+            double maxDistance = 2.5;
+            unsigned int workersCount = 0;
+            std::string outputPath;
+        };
+
+        struct Label
+        {
+            char letter = 0;
+            cv::Rect bbox;
+        };
+
+        struct LabelledImg
+        {
+            std::string path;
+            std::vector<Label> labels;
+        };
+
+        struct Sample
+        {
+            char letter = 0;
+            std::array<double, pobr::imgProcessing::structs::Classifier::invariantsCount> huInvariants;
+            // Whether the segment never reaches the classifier, whatever the model
+            bool isGeometryRejected = false;
+        };
+
+        struct ImgSamples
+        {
+            std::vector<Sample> samples;
+            uint64_t unmatchedCount = 0;
+            std::string error;
+        };
+
+        Config config;
+
+        const std::vector<LabelledImg> loadLabels() const;
+        const std::vector<ImgSamples> collectSamples(const std::vector<LabelledImg>& labelledImgs) const;
+        const ImgSamples collectImgSamples(
+            const LabelledImg& labelledImg,
+            pobr::imgProcessing::ImgProcessor& imgProcessor
+        ) const;
+        const pobr::imgProcessing::structs::Classifier buildModel(const std::vector<ImgSamples>& imgsSamples) const;
+    };
+}
+
+#endif
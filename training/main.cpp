@@ -0,0 +1,15 @@
+#include <vector>
+#include <string>
+
+#include "./TrainingApp.hpp"
+
+using TrainingApp = pobr::training::TrainingApp;
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> arguments(argv + 1, argv + argc);
+
+    TrainingApp myApp(arguments);
+
+    return 0;
+}